@@ -0,0 +1,294 @@
+#include "aliasing.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_TABLES 4
+#define NO_BRANCH 0xffffffffu
+
+struct table {
+    const char *name;
+    uint32_t entries;
+    int counter_bits;
+    uint32_t *last_pc;          // branch that last used each entry
+    uint64_t reads;
+    uint64_t aliased;
+    uint64_t constructive;
+    uint64_t destructive;
+    // per entry
+    uint64_t *entry_reads;
+    uint32_t *branches;
+    uint32_t *contexts;
+    uint8_t *counters;
+};
+
+// private counters, keyed by (table, index, pc) in an open-addressed hash table
+struct shadow {
+    uint64_t key;               // 0 marks an empty slot
+    uint8_t counter;
+};
+
+// (table, index, pc, history) contexts seen, as 64-bit fingerprints
+struct context_set {
+    uint64_t *keys;             // 0 marks an empty slot
+    uint32_t mask;
+    uint32_t count;
+};
+
+struct aliasing {
+    struct table tables[MAX_TABLES];
+    int num_tables;
+    struct shadow *shadows;
+    uint32_t shadow_mask;
+    uint32_t shadow_count;
+    struct context_set contexts;
+};
+
+struct aliasing *aliasing_create(void) {
+    struct aliasing *a = calloc(1, sizeof(struct aliasing));
+    if (!a) return NULL;
+    a->shadow_mask = (1u << 12) - 1;
+    a->shadows = calloc(a->shadow_mask + 1, sizeof(struct shadow));
+    a->contexts.mask = (1u << 12) - 1;
+    a->contexts.keys = calloc(a->contexts.mask + 1, sizeof(uint64_t));
+    if (!a->shadows || !a->contexts.keys) {
+        aliasing_delete(a);
+        return NULL;
+    }
+    return a;
+}
+
+void aliasing_delete(struct aliasing *a) {
+    if (!a) return;
+    for (int i = 0; i < a->num_tables; i++) {
+        free(a->tables[i].last_pc);
+        free(a->tables[i].entry_reads);
+        free(a->tables[i].branches);
+        free(a->tables[i].contexts);
+        free(a->tables[i].counters);
+    }
+    free(a->shadows);
+    free(a->contexts.keys);
+    free(a);
+}
+
+int aliasing_add_table(struct aliasing *a, const char *name, uint32_t entries, int counter_bits) {
+    if (a->num_tables == MAX_TABLES) return -1;
+    struct table *t = &a->tables[a->num_tables];
+    t->last_pc = malloc(entries * sizeof(uint32_t));
+    t->entry_reads = calloc(entries, sizeof(uint64_t));
+    t->branches = calloc(entries, sizeof(uint32_t));
+    t->contexts = calloc(entries, sizeof(uint32_t));
+    t->counters = calloc(entries, sizeof(uint8_t));
+    if (!t->last_pc || !t->entry_reads || !t->branches || !t->contexts || !t->counters) {
+        free(t->last_pc);
+        free(t->entry_reads);
+        free(t->branches);
+        free(t->contexts);
+        free(t->counters);
+        *t = (struct table){ 0 };
+        return -1;
+    }
+    for (uint32_t i = 0; i < entries; i++) {
+        t->last_pc[i] = NO_BRANCH;
+    }
+    t->name = name;
+    t->entries = entries;
+    t->counter_bits = counter_bits;
+    return a->num_tables++;
+}
+
+static uint32_t hash_key(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+// MurmurHash3's 64-bit finalizer, a bijection mixing every bit into the result
+static uint64_t mix64(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+static struct shadow *find_slot(struct shadow *shadows, uint32_t mask, uint64_t key) {
+    uint32_t slot = hash_key(key) & mask;
+    while (shadows[slot].key != 0 && shadows[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return &shadows[slot];
+}
+
+static void grow(struct aliasing *a) {
+    uint32_t mask = a->shadow_mask * 2 + 1;
+    struct shadow *shadows = calloc((size_t)mask + 1, sizeof(struct shadow));
+    if (!shadows) {
+        fprintf(stderr, "Out of memory for aliasing statistics\n");
+        exit(-1);
+    }
+    for (uint32_t i = 0; i <= a->shadow_mask; i++) {
+        if (a->shadows[i].key != 0) {
+            *find_slot(shadows, mask, a->shadows[i].key) = a->shadows[i];
+        }
+    }
+    free(a->shadows);
+    a->shadows = shadows;
+    a->shadow_mask = mask;
+}
+
+// Adds a context; returns 1 if it had not been seen before.
+static int context_add(struct context_set *set, uint64_t key) {
+    key = key ? key : 1;
+    uint32_t slot = hash_key(key) & set->mask;
+    while (set->keys[slot] != 0) {
+        if (set->keys[slot] == key) return 0;
+        slot = (slot + 1) & set->mask;
+    }
+    if (2 * (set->count + 1) > set->mask) {
+        uint32_t mask = set->mask * 2 + 1;
+        uint64_t *keys = calloc((size_t)mask + 1, sizeof(uint64_t));
+        if (!keys) {
+            fprintf(stderr, "Out of memory for aliasing statistics\n");
+            exit(-1);
+        }
+        for (uint32_t i = 0; i <= set->mask; i++) {
+            if (set->keys[i] == 0) continue;
+            uint32_t s = hash_key(set->keys[i]) & mask;
+            while (keys[s] != 0) s = (s + 1) & mask;
+            keys[s] = set->keys[i];
+        }
+        free(set->keys);
+        set->keys = keys;
+        set->mask = mask;
+        slot = hash_key(key) & mask;
+        while (keys[slot] != 0) slot = (slot + 1) & mask;
+    }
+    set->keys[slot] = key;
+    set->count++;
+    return 1;
+}
+
+// private counter for this branch and entry, created weakly taken like the tables;
+// a new one means a new branch for the entry
+static uint8_t *shadow_counter(struct aliasing *a, int table, uint32_t index, uint32_t pc) {
+    uint64_t key = ((uint64_t)pc << 32) | ((uint64_t)(table + 1) << 28) | index;
+    struct shadow *s = find_slot(a->shadows, a->shadow_mask, key);
+    if (s->key == 0) {
+        if (2 * (a->shadow_count + 1) > a->shadow_mask) {
+            grow(a);
+            s = find_slot(a->shadows, a->shadow_mask, key);
+        }
+        s->key = key;
+        s->counter = 2;
+        a->shadow_count++;
+        a->tables[table].branches[index]++;
+    }
+    return &s->counter;
+}
+
+void aliasing_observe(struct aliasing *a, int table, uint32_t index, uint32_t pc, uint64_t history,
+                      int prediction, int taken) {
+    struct table *t = &a->tables[table];
+    uint8_t *counter = shadow_counter(a, table, index, pc);
+    int private_prediction = *counter >= 2;
+    uint64_t context = ((uint64_t)pc << 32) | ((uint64_t)(table + 1) << 28) | index;
+    // for a given (pc, table, index) every history gets a different fingerprint
+    if (context_add(&a->contexts, mix64(mix64(context) ^ history))) {
+        t->contexts[index]++;
+    }
+    t->reads++;
+    t->entry_reads[index]++;
+    if (t->last_pc[index] != NO_BRANCH && t->last_pc[index] != pc) {
+        t->aliased++;
+        if (prediction == taken && private_prediction != taken) t->constructive++;
+        if (prediction != taken && private_prediction == taken) t->destructive++;
+    }
+    t->last_pc[index] = pc;
+    if (taken) {
+        if (*counter < 3) (*counter)++;
+    } else {
+        if (*counter > 0) (*counter)--;
+    }
+}
+
+void aliasing_set_counter(struct aliasing *a, int table, uint32_t index, unsigned value) {
+    a->tables[table].counters[index] = (uint8_t)value;
+}
+
+// touched entries by number of users: 1, 2, 3-4, 5-8, 9-16, more
+#define USER_BUCKETS 6
+
+static void print_users(const char *what, const uint32_t *users, uint32_t entries) {
+    static const char *labels[USER_BUCKETS] = { "1", "2", "3-4", "5-8", "9-16", ">16" };
+    uint64_t buckets[USER_BUCKETS] = { 0 };
+    uint32_t max = 0;
+    for (uint32_t i = 0; i < entries; i++) {
+        if (users[i] == 0) continue;
+        int b = 0;
+        while (b < USER_BUCKETS - 1 && users[i] > (1u << b)) b++;
+        buckets[b]++;
+        if (users[i] > max) max = users[i];
+    }
+    printf("    %s per touched entry:", what);
+    for (int b = 0; b < USER_BUCKETS; b++) {
+        printf(" %s: %lu", labels[b], buckets[b]);
+    }
+    printf(" (max %u)\n", max);
+}
+
+// counter values, in at most 16 ranges for wide counters
+static void print_counters(const struct table *t) {
+    uint64_t states[16] = { 0 };
+    int values = 1 << t->counter_bits;
+    int width = values > 16 ? values / 16 : 1;
+    for (uint32_t i = 0; i < t->entries; i++) {
+        states[t->counters[i] / width]++;
+    }
+    printf("    counter states:");
+    for (int s = 0; s < values / width; s++) {
+        if (width == 1) {
+            printf(" %d: %lu", s, states[s]);
+        } else {
+            printf(" %d-%d: %lu", s * width, (s + 1) * width - 1, states[s]);
+        }
+    }
+    printf("\n");
+}
+
+void aliasing_print(const struct aliasing *a) {
+    printf("Aliasing (reads of entries last used by another branch):\n");
+    for (int i = 0; i < a->num_tables; i++) {
+        const struct table *t = &a->tables[i];
+        printf("  %-10s %6u entries: %lu reads, %lu aliased", t->name, t->entries, t->reads, t->aliased);
+        if (t->reads > 0) {
+            printf(" (%.2f%%)", 100.0 * t->aliased / t->reads);
+        }
+        printf(", %lu constructive, %lu destructive\n", t->constructive, t->destructive);
+        uint32_t touched = 0;
+        for (uint32_t e = 0; e < t->entries; e++) {
+            touched += t->entry_reads[e] > 0;
+        }
+        printf("    touched: %u of %u entries (%.2f%%)\n", touched, t->entries,
+               t->entries ? 100.0 * touched / t->entries : 0.0);
+        print_users("branches", t->branches, t->entries);
+        print_users("branch/history contexts", t->contexts, t->entries);
+        print_counters(t);
+    }
+}
+
+int aliasing_write(const struct aliasing *a, const char *file_name) {
+    FILE *f = fopen(file_name, "w");
+    if (!f) return -1;
+    fprintf(f, "table,index,reads,branches,contexts,counter\n");
+    for (int i = 0; i < a->num_tables; i++) {
+        const struct table *t = &a->tables[i];
+        for (uint32_t e = 0; e < t->entries; e++) {
+            fprintf(f, "%s,%u,%lu,%u,%u,%u\n", t->name, e, t->entry_reads[e], t->branches[e],
+                    t->contexts[e], t->counters[e]);
+        }
+    }
+    return fclose(f) ? -1 : 0;
+}
@@ -0,0 +1,38 @@
+#ifndef __ALIASING_H__
+#define __ALIASING_H__
+
+#include <stdint.h>
+
+// Interference measurement for predictor tables. Every counter read for a
+// prediction is reported together with the branch that read it. A read is
+// aliased when the entry was last used by a different branch. Aliased reads are
+// classified against a private 2-bit counter for the same (branch, entry)
+// that no other branch touches: constructive when the shared entry predicted
+// correctly and the private one would not have, destructive in the reverse case.
+//
+// Utilization is tracked per entry as well: reads, distinct branches and
+// distinct (branch, history) contexts that used the entry, and its counter
+// value as last reported by the predictor.
+struct aliasing;
+
+struct aliasing *aliasing_create(void);
+void aliasing_delete(struct aliasing *a);
+
+// registers a table of 'entries' counters of 'counter_bits' bits and returns its id
+int aliasing_add_table(struct aliasing *a, const char *name, uint32_t entries, int counter_bits);
+
+// 'prediction' is what the shared entry predicted for the branch at 'pc';
+// 'history' is the global history that went into the index (0 if none)
+void aliasing_observe(struct aliasing *a, int table, uint32_t index, uint32_t pc, uint64_t history,
+                      int prediction, int taken);
+
+// current value of a counter, set by the predictor before printing or writing
+void aliasing_set_counter(struct aliasing *a, int table, uint32_t index, unsigned value);
+
+void aliasing_print(const struct aliasing *a);
+
+// Writes one CSV row per entry (table, index, reads, branches, contexts,
+// counter) for plotting as a heatmap; returns -1 on failure.
+int aliasing_write(const struct aliasing *a, const char *file_name);
+
+#endif
@@ -0,0 +1,273 @@
+// Predictor microbenchmark: feeds synthetic branch streams straight into the
+// predictors, without simulating a program, and reports the misprediction rate
+// and the host time per update.
+//   make bench && bench/predictor_bench -n 1M gshare-4K gshare:entries=64K,hist=16
+#include "../branch_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LOOPS 8
+#define MAX_PREDICTORS 32
+#define BIASED_BRANCHES 16
+
+typedef struct {
+    uint32_t pc;
+    uint32_t target;
+    uint32_t taken;
+} branch_t;
+
+typedef struct {
+    long branches;
+    uint64_t seed;
+    int trips[MAX_LOOPS];
+    int loops;
+    int bias;                   // percent taken
+    int aliasing_branches;
+    int repeats;
+    int predict_first;          // call predictor_predict() before each update
+    const char *only;
+} options_t;
+
+typedef struct {
+    const char *name;
+    void (*generate)(branch_t *stream, long count, const options_t *options, uint64_t *rng);
+} workload_t;
+
+static uint64_t next_random(uint64_t *state) {
+    // xorshift64*
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static int random_bit(uint64_t *state) {
+    return next_random(state) >> 63;
+}
+
+static void set_branch(branch_t *b, uint32_t pc, int backward, int taken) {
+    b->pc = pc;
+    b->target = backward ? pc - 0x40 : pc + 0x40;
+    b->taken = taken != 0;
+}
+
+// Loops with the given trip counts, one after the other inside an outer loop;
+// each inner back-edge is taken trip - 1 times and then falls through.
+static void generate_loops(branch_t *stream, long count, const options_t *options, uint64_t *rng) {
+    (void)rng;
+    long n = 0;
+    while (n < count) {
+        for (int l = 0; l < options->loops && n < count; l++) {
+            for (int i = 1; i <= options->trips[l] && n < count; i++) {
+                set_branch(&stream[n++], 0x1000 + 0x100 * l, 1, i < options->trips[l]);
+            }
+        }
+        if (n < count) set_branch(&stream[n++], 0x1ffc, 1, 1);
+    }
+}
+
+// An if-chain where two branches are random and the next two repeat them: the
+// third is taken when exactly one of the first two was, the fourth with the
+// first. Only the first two cannot be learned.
+static void generate_correlated(branch_t *stream, long count, const options_t *options, uint64_t *rng) {
+    (void)options;
+    long n = 0;
+    while (n < count) {
+        int b1 = random_bit(rng);
+        int b2 = random_bit(rng);
+        int outcomes[5] = { b1, b2, b1 ^ b2, b1, 1 };
+        for (int i = 0; i < 5 && n < count; i++) {
+            set_branch(&stream[n++], 0x2000 + 4 * i, i == 4, outcomes[i]);
+        }
+    }
+}
+
+// A few branches, visited in random order, each taken with the same probability
+static void generate_biased(branch_t *stream, long count, const options_t *options, uint64_t *rng) {
+    for (long n = 0; n < count; n++) {
+        uint32_t pc = 0x3000 + 4 * (uint32_t)(next_random(rng) % BIASED_BRANCHES);
+        set_branch(&stream[n], pc, 0, (int)(next_random(rng) % 100) < options->bias);
+    }
+}
+
+// Many branches that always go the same (random) way, visited in random order:
+// trivially predictable, but only if they do not share counters
+static void generate_aliasing(branch_t *stream, long count, const options_t *options, uint64_t *rng) {
+    uint64_t directions = next_random(rng);
+    for (long n = 0; n < count; n++) {
+        uint32_t i = (uint32_t)(next_random(rng) % (uint64_t)options->aliasing_branches);
+        // a mix of the branch number into a 64-bit pattern gives each its direction
+        int taken = (directions >> ((i * 0x9E3779B1u) >> 26)) & 1;
+        set_branch(&stream[n], 0x10000 + 4 * i, 0, taken);
+    }
+}
+
+static const workload_t workloads[] = {
+    { "loop",       generate_loops },
+    { "correlated", generate_correlated },
+    { "biased",     generate_biased },
+    { "aliasing",   generate_aliasing },
+};
+#define WORKLOAD_COUNT (int)(sizeof(workloads) / sizeof(workloads[0]))
+
+static const char *default_predictors[] = {
+    "bimodal-4K", "gshare-4K", "tage-sc-l-8K", "perceptron-1K"
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Runs the stream through a fresh predictor 'repeats' times. Returns -1 if the
+// predictor cannot be created, otherwise the mispredictions of one run and the
+// fastest run's time in '*ns'.
+static int run_stream(const char *spec, const branch_t *stream, long count, const options_t *options,
+                      uint64_t *mispredictions, uint64_t *ns) {
+    *ns = UINT64_MAX;
+    for (int r = 0; r < options->repeats; r++) {
+        branch_predictor_t *pred = predictor_create_named(spec);
+        if (!pred) return -1;
+        predictor_update_fn update = pred->update;
+        uint64_t start = now_ns();
+        if (options->predict_first) {
+            for (long n = 0; n < count; n++) {
+                predictor_predict(pred, stream[n].pc, stream[n].target);
+                update(pred, stream[n].pc, stream[n].target, stream[n].taken);
+            }
+        } else {
+            for (long n = 0; n < count; n++) {
+                update(pred, stream[n].pc, stream[n].target, stream[n].taken);
+            }
+        }
+        predictor_flush(pred);
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed < *ns) *ns = elapsed;
+        *mispredictions = pred->stats.mispredictions;
+        predictor_destroy(pred);
+    }
+    return 0;
+}
+
+static long parse_count(const char *str) {
+    char *end;
+    long value = strtol(str, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        value *= 1024;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        value *= 1024 * 1024;
+        end++;
+    }
+    return (*end || value <= 0) ? -1 : value;
+}
+
+static int parse_trips(const char *str, options_t *options) {
+    char buffer[256];
+    if (strlen(str) >= sizeof(buffer)) return -1;
+    strcpy(buffer, str);
+    options->loops = 0;
+    for (char *t = strtok(buffer, ","); t; t = strtok(NULL, ",")) {
+        long trip = parse_count(t);
+        if (trip <= 0 || trip > 1 << 20 || options->loops == MAX_LOOPS) return -1;
+        options->trips[options->loops++] = (int)trip;
+    }
+    return options->loops ? 0 : -1;
+}
+
+static void usage(void) {
+    printf("usage: predictor_bench [options] [predictor ...]\n");
+    printf("  -n N        branches per workload (K/M suffixes, default 1M)\n");
+    printf("  -s SEED     seed of the random streams (default 1)\n");
+    printf("  -t T[,T..]  loop trip counts, up to %d loops (default 10)\n", MAX_LOOPS);
+    printf("  -b P        percent taken of the biased branches (default 90)\n");
+    printf("  -a N        branches of the aliasing workload (K/M suffixes, default 64K)\n");
+    printf("  -w NAME     run only one workload: loop, correlated, biased or aliasing\n");
+    printf("  -r N        runs per measurement, the fastest is reported (default 3)\n");
+    printf("  -P          call predictor_predict() before each update, as a front end would\n");
+    printf("  predictors are named as for sim -p: fixed types, bimodal:/gshare: specifications,\n");
+    printf("  tage-sc-l-NK, tournament-B-G, pag-/pap-/sag-H-P, profile:, oracle: or plugin: (default");
+    for (size_t i = 0; i < sizeof(default_predictors) / sizeof(default_predictors[0]); i++) {
+        printf(" %s", default_predictors[i]);
+    }
+    printf(")\n");
+    exit(-1);
+}
+
+int main(int argc, char *argv[]) {
+    options_t options = { 1024 * 1024, 1, { 10 }, 1, 90, 64 * 1024, 3, 0, NULL };
+    const char *predictors[MAX_PREDICTORS];
+    int predictor_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "-n") && has_value) {
+            if ((options.branches = parse_count(argv[++i])) < 0) usage();
+        } else if (!strcmp(argv[i], "-s") && has_value) {
+            options.seed = strtoull(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "-t") && has_value) {
+            if (parse_trips(argv[++i], &options) < 0) usage();
+        } else if (!strcmp(argv[i], "-b") && has_value) {
+            options.bias = atoi(argv[++i]);
+            if (options.bias < 0 || options.bias > 100) usage();
+        } else if (!strcmp(argv[i], "-a") && has_value) {
+            long branches = parse_count(argv[++i]);
+            if (branches <= 0 || branches > 1 << 24) usage();
+            options.aliasing_branches = (int)branches;
+        } else if (!strcmp(argv[i], "-w") && has_value) {
+            options.only = argv[++i];
+        } else if (!strcmp(argv[i], "-r") && has_value) {
+            if ((options.repeats = atoi(argv[++i])) <= 0) usage();
+        } else if (!strcmp(argv[i], "-P")) {
+            options.predict_first = 1;
+        } else if (argv[i][0] == '-' || predictor_count == MAX_PREDICTORS) {
+            usage();
+        } else {
+            predictors[predictor_count++] = argv[i];
+        }
+    }
+    if (predictor_count == 0) {
+        for (size_t i = 0; i < sizeof(default_predictors) / sizeof(default_predictors[0]); i++) {
+            predictors[predictor_count++] = default_predictors[i];
+        }
+    }
+    if (options.seed == 0) options.seed = 1;    // xorshift gets stuck at 0
+
+    int matched = 0;
+    for (int w = 0; w < WORKLOAD_COUNT; w++) {
+        if (!options.only || !strcmp(options.only, workloads[w].name)) matched = 1;
+    }
+    if (!matched) {
+        printf("Unknown workload: %s\n", options.only);
+        return -1;
+    }
+
+    branch_t *stream = malloc(options.branches * sizeof(branch_t));
+    if (!stream) {
+        printf("Could not allocate %ld branches\n", options.branches);
+        return -1;
+    }
+
+    printf("%-12s %-32s %12s %12s %10s\n", "Workload", "Predictor", "Branches", "Mispredicts", "ns/update");
+    for (int w = 0; w < WORKLOAD_COUNT; w++) {
+        if (options.only && strcmp(options.only, workloads[w].name)) continue;
+        // every workload sees the same seed, whichever are selected
+        uint64_t rng = options.seed;
+        workloads[w].generate(stream, options.branches, &options, &rng);
+        for (int p = 0; p < predictor_count; p++) {
+            uint64_t mispredictions = 0, ns;
+            if (run_stream(predictors[p], stream, options.branches, &options, &mispredictions, &ns) < 0) {
+                free(stream);
+                return -1;
+            }
+            printf("%-12s %-32s %12ld %11.2f%% %10.2f\n", workloads[w].name, predictors[p],
+                   options.branches, 100.0 * mispredictions / options.branches,
+                   (double)ns / options.branches);
+        }
+    }
+    free(stream);
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include "branch_analysis.h"
+#include "disassemble.h"
+#include "outcome_profile.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_HISTORY 16
+#define NUM_LENGTHS 7
+static const int history_lengths[NUM_LENGTHS] = { 0, 1, 2, 4, 8, 12, 16 };
+
+// classification thresholds
+#define BIASED 0.95             // share of the majority direction
+#define LOOP_REGULAR 0.9        // share of runs with the loop's period
+#define LOOP_MIN_RUNS 3
+#define CORRELATED_BITS 0.1     // conditional entropy per execution
+#define MIN_SAMPLES 16          // executions per history context to trust its entropy
+
+typedef enum {
+    CLASS_ALWAYS,
+    CLASS_NEVER,
+    CLASS_BIASED,
+    CLASS_LOOP,
+    CLASS_CORRELATED,
+    CLASS_OTHER,
+    NUM_CLASSES
+} branch_class_t;
+
+static const char *class_names[NUM_CLASSES] = {
+    "always taken", "never taken", "biased", "loop", "correlated", "other"
+};
+static const char *class_families[NUM_CLASSES] = {
+    "static", "static", "bimodal", "loop predictor", "global history (gshare, TAGE)",
+    "none of these (data dependent)"
+};
+
+struct branch_stats {
+    uint32_t pc;                // 0 marks an empty slot
+    uint64_t executions;
+    uint64_t taken;
+    int last;                   // previous outcome
+    uint64_t run;               // length of the current run of equal outcomes
+    // completed runs per direction ([0] not taken, [1] taken); the most common
+    // length is found with a majority vote, 'matches' counts the runs of that
+    // length since it became the candidate
+    uint64_t runs[2];
+    uint64_t long_runs[2];      // runs longer than one outcome
+    uint64_t candidate[2];
+    uint64_t votes[2];
+    uint64_t matches[2];
+    // filled in when reporting
+    double entropy[NUM_LENGTHS];
+    uint32_t contexts[NUM_LENGTHS];
+    branch_class_t class;
+    int period;                 // loops: executions per loop instance
+    int correlation;            // correlated: history bits needed
+};
+
+// open-addressed hash table of branches, kept at most half full, plus the
+// outcome histograms per branch and history
+struct branch_analysis {
+    struct branch_stats *slots;
+    uint32_t mask;
+    uint32_t count;
+    struct outcome_profile *histograms;
+};
+
+struct branch_analysis *branch_analysis_create(void) {
+    struct branch_analysis *ba = calloc(1, sizeof(struct branch_analysis));
+    if (!ba) return NULL;
+    ba->mask = (1u << 8) - 1;
+    ba->slots = calloc(ba->mask + 1, sizeof(struct branch_stats));
+    ba->histograms = outcome_profile_create(MAX_HISTORY);
+    if (!ba->slots || !ba->histograms) {
+        branch_analysis_delete(ba);
+        return NULL;
+    }
+    return ba;
+}
+
+void branch_analysis_delete(struct branch_analysis *ba) {
+    if (ba) {
+        free(ba->slots);
+        outcome_profile_delete(ba->histograms);
+        free(ba);
+    }
+}
+
+static struct branch_stats *find_slot(struct branch_stats *slots, uint32_t mask, uint32_t pc) {
+    uint32_t slot = ((pc >> 2) * 0x9e3779b1u) & mask;
+    while (slots[slot].pc != 0 && slots[slot].pc != pc) {
+        slot = (slot + 1) & mask;
+    }
+    return &slots[slot];
+}
+
+static void grow(struct branch_analysis *ba) {
+    uint32_t mask = ba->mask * 2 + 1;
+    struct branch_stats *slots = calloc((size_t)mask + 1, sizeof(struct branch_stats));
+    if (!slots) {
+        fprintf(stderr, "Out of memory for branch analysis\n");
+        exit(-1);
+    }
+    for (uint32_t i = 0; i <= ba->mask; i++) {
+        if (ba->slots[i].pc != 0) {
+            *find_slot(slots, mask, ba->slots[i].pc) = ba->slots[i];
+        }
+    }
+    free(ba->slots);
+    ba->slots = slots;
+    ba->mask = mask;
+}
+
+static void end_run(struct branch_stats *b) {
+    int d = b->last;
+    b->runs[d]++;
+    if (b->run > 1) b->long_runs[d]++;
+    if (b->votes[d] == 0) {
+        b->candidate[d] = b->run;
+        b->votes[d] = 1;
+        b->matches[d] = 1;
+    } else if (b->candidate[d] == b->run) {
+        b->votes[d]++;
+        b->matches[d]++;
+    } else {
+        b->votes[d]--;
+    }
+}
+
+void branch_analysis_record(struct branch_analysis *ba, uint32_t pc, int taken) {
+    taken = taken != 0;
+    struct branch_stats *b = find_slot(ba->slots, ba->mask, pc);
+    if (b->pc == 0) {
+        if (2 * (ba->count + 1) > ba->mask) {
+            grow(ba);
+            b = find_slot(ba->slots, ba->mask, pc);
+        }
+        b->pc = pc;
+        b->last = taken;
+        ba->count++;
+    }
+    if (b->executions > 0 && taken != b->last) {
+        end_run(b);
+        b->run = 0;
+    }
+    b->last = taken;
+    b->run++;
+    b->executions++;
+    b->taken += (uint64_t)taken;
+    outcome_profile_record(ba->histograms, pc, taken);
+}
+
+static double binary_entropy(uint64_t taken, uint64_t not_taken) {
+    double n = (double)(taken + not_taken);
+    double h = 0.0;
+    if (taken) h -= taken / n * log2(taken / n);
+    if (not_taken) h -= not_taken / n * log2(not_taken / n);
+    return h;
+}
+
+struct entropy_pass {
+    struct branch_analysis *ba;
+    int length;
+};
+
+// adds one history context's share of its branch's conditional entropy
+static void add_context(void *arg, uint32_t pc, uint64_t history, uint64_t taken, uint64_t not_taken) {
+    struct entropy_pass *pass = arg;
+    struct branch_stats *b = find_slot(pass->ba->slots, pass->ba->mask, pc);
+    (void)history;
+    b->entropy[pass->length] += (double)(taken + not_taken) * binary_entropy(taken, not_taken);
+    b->contexts[pass->length]++;
+}
+
+static void classify(struct branch_stats *b) {
+    double bias = (double)b->taken / b->executions;
+    if (b->taken == b->executions) {
+        b->class = CLASS_ALWAYS;
+        return;
+    }
+    if (b->taken == 0) {
+        b->class = CLASS_NEVER;
+        return;
+    }
+    if (bias >= BIASED || bias <= 1.0 - BIASED) {
+        b->class = CLASS_BIASED;
+        return;
+    }
+    // a loop branch repeats one direction a fixed number of times, then takes
+    // the other once
+    for (int d = 0; d < 2; d++) {
+        if (b->runs[d] >= LOOP_MIN_RUNS && b->long_runs[!d] == 0 && b->candidate[d] > 1
+            && b->matches[d] >= LOOP_REGULAR * b->runs[d]) {
+            b->class = CLASS_LOOP;
+            b->period = (int)b->candidate[d] + 1;
+            return;
+        }
+    }
+    for (int i = 1; i < NUM_LENGTHS; i++) {
+        if (b->entropy[i] <= CORRELATED_BITS
+            && b->executions >= (uint64_t)MIN_SAMPLES * b->contexts[i]) {
+            b->class = CLASS_CORRELATED;
+            b->correlation = history_lengths[i];
+            return;
+        }
+    }
+    b->class = CLASS_OTHER;
+}
+
+static int by_executions(const void *a, const void *b) {
+    const struct branch_stats *x = *(const struct branch_stats * const *)a;
+    const struct branch_stats *y = *(const struct branch_stats * const *)b;
+    if (x->executions != y->executions) {
+        return x->executions < y->executions ? 1 : -1;
+    }
+    return x->pc < y->pc ? -1 : x->pc > y->pc;
+}
+
+void branch_analysis_print(const struct branch_analysis *ba, int top,
+                           struct memory *mem, struct symbols *symbols) {
+    // the analysis is finished on a copy of the branch table
+    struct branch_analysis work = *ba;
+    work.slots = malloc(((size_t)ba->mask + 1) * sizeof(struct branch_stats));
+    const struct branch_stats **sorted = malloc((ba->count + 1) * sizeof(*sorted));
+    if (!work.slots || !sorted) {
+        free(work.slots);
+        free(sorted);
+        return;
+    }
+    for (uint32_t i = 0; i <= ba->mask; i++) {
+        work.slots[i] = ba->slots[i];
+    }
+    for (int i = 0; i < NUM_LENGTHS; i++) {
+        struct outcome_profile *reduced = outcome_profile_reduce(ba->histograms, history_lengths[i]);
+        if (!reduced) continue;
+        struct entropy_pass pass = { &work, i };
+        outcome_profile_foreach(reduced, add_context, &pass);
+        outcome_profile_delete(reduced);
+    }
+
+    uint64_t total = 0;
+    uint64_t class_branches[NUM_CLASSES] = { 0 };
+    uint64_t class_executions[NUM_CLASSES] = { 0 };
+    double weighted_entropy[NUM_LENGTHS] = { 0 };
+    uint32_t n = 0;
+    for (uint32_t i = 0; i <= work.mask; i++) {
+        struct branch_stats *b = &work.slots[i];
+        if (b->pc == 0) continue;
+        for (int l = 0; l < NUM_LENGTHS; l++) {
+            weighted_entropy[l] += b->entropy[l];
+            b->entropy[l] /= (double)b->executions;
+        }
+        classify(b);
+        total += b->executions;
+        class_branches[b->class]++;
+        class_executions[b->class] += b->executions;
+        sorted[n++] = b;
+    }
+
+    printf("\n=== Branch Predictability (%u branches, %lu executions) ===\n", n, total);
+    printf("%-13s %8s %12s %8s  %s\n", "class", "branches", "executions", "share", "helped by");
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        printf("%-13s %8lu %12lu %7.2f%%  %s\n", class_names[c], class_branches[c], class_executions[c],
+               total ? 100.0 * class_executions[c] / total : 0.0, class_families[c]);
+    }
+    printf("Conditional entropy (bits/branch) given k bits of global history:\n ");
+    for (int l = 0; l < NUM_LENGTHS; l++) {
+        printf(" k=%d: %.4f", history_lengths[l], total ? weighted_entropy[l] / total : 0.0);
+    }
+    printf("\n");
+
+    qsort(sorted, n, sizeof(*sorted), by_executions);
+    if ((uint32_t)top > n) top = (int)n;
+    printf("Top %d branches by executions:\n", top);
+    printf("%-8s  %-22s %10s %7s  %-16s", "pc", "function", "executed", "taken", "class");
+    for (int l = 0; l < NUM_LENGTHS; l++) {
+        printf("   H%-3d", history_lengths[l]);
+    }
+    printf("  instruction\n");
+    for (int i = 0; i < top; i++) {
+        const struct branch_stats *b = sorted[i];
+        char where[64];
+        char class[32];
+        char disassembly[100];
+        unsigned int offset;
+        const char *function = symbols ? symbols_containing_function(symbols, b->pc, &offset) : NULL;
+        if (function) {
+            snprintf(where, sizeof(where), "%s+0x%x", function, offset);
+        } else {
+            snprintf(where, sizeof(where), "?");
+        }
+        if (b->class == CLASS_LOOP) {
+            snprintf(class, sizeof(class), "loop, period %d", b->period);
+        } else if (b->class == CLASS_CORRELATED) {
+            snprintf(class, sizeof(class), "correlated, k=%d", b->correlation);
+        } else {
+            snprintf(class, sizeof(class), "%s", class_names[b->class]);
+        }
+        printf("%08x  %-22s %10lu %6.1f%%  %-16s", b->pc, where, b->executions,
+               100.0 * b->taken / b->executions, class);
+        for (int l = 0; l < NUM_LENGTHS; l++) {
+            printf(" %6.3f", b->entropy[l]);
+        }
+        disassemble(b->pc, (uint32_t)memory_rd_w(mem, (int)b->pc), disassembly, sizeof(disassembly), symbols);
+        printf("  %s\n", disassembly);
+    }
+    printf("=====================================================\n\n");
+    free(work.slots);
+    free(sorted);
+}
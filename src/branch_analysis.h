@@ -0,0 +1,24 @@
+#ifndef __BRANCH_ANALYSIS_H__
+#define __BRANCH_ANALYSIS_H__
+
+#include <stdint.h>
+#include "memory.h"
+#include "read_elf.h"
+
+// Predictability analysis of conditional branches, built online from their
+// outcomes. Each static branch is classified as always taken, never taken,
+// strongly biased, loop-like with a fixed period, correlated with the last k
+// global outcomes, or none of these, and its conditional entropy given 0..16
+// bits of global history is computed.
+struct branch_analysis;
+
+struct branch_analysis *branch_analysis_create(void);
+void branch_analysis_delete(struct branch_analysis *ba);
+
+void branch_analysis_record(struct branch_analysis *ba, uint32_t pc, int taken);
+
+// Prints the summary per class and the 'top' most executed branches.
+void branch_analysis_print(const struct branch_analysis *ba, int top,
+                           struct memory *mem, struct symbols *symbols);
+
+#endif
@@ -1,6 +1,14 @@
 #include "branch_predictor.h"
+#include "tage.h"
+#include "aliasing.h"
+#include "branch_profile.h"
+#include "branch_analysis.h"
+#include "outcome_profile.h"
 #include <stdlib.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 static int get_table_size(predictor_type_t type) {
     switch (type) {
@@ -21,6 +29,522 @@ static int get_table_size(predictor_type_t type) {
     }
 }
 
+static int get_tage_budget_kb(predictor_type_t type) {
+    switch (type) {
+        case PRED_TAGE_SC_L_8K:  return 8;
+        case PRED_TAGE_SC_L_32K: return 32;
+        case PRED_TAGE_SC_L_64K: return 64;
+        default:                 return 0;
+    }
+}
+
+// Perceptron predictor (Jimenez & Lin): one weight vector per PC hash, dotted
+// with the global history as +1/-1 inputs. Budgets match the bimodal/gshare
+// points by storage bits (2 bits per entry), with 8-bit weights:
+// 256 -> 8 x 8 weights, 1K -> 16 x 16, 4K -> 32 x 32, 16K -> 64 x 64.
+#define PERCEPTRON_MAX_WEIGHTS 64
+#define PERCEPTRON_WEIGHT_MAX 127   // symmetric, so negating a weight cannot overflow
+
+struct perceptron {
+    int count;                  // number of weight vectors, power of two
+    int num_weights;            // bias weight + history length
+    int stride;                 // vector length rounded up to the SIMD width
+    int threshold;
+    int8_t *weights;
+    // input i as a byte mask: 0 for +1 (taken), -1 for -1 (not taken);
+    // inputs[0] is the bias input and always +1, padding inputs stay 0
+    int8_t inputs[PERCEPTRON_MAX_WEIGHTS];
+};
+
+static int get_perceptron_size(predictor_type_t type) {
+    switch (type) {
+        case PRED_PERCEPTRON_256: return 8;
+        case PRED_PERCEPTRON_1K:  return 16;
+        case PRED_PERCEPTRON_4K:  return 32;
+        case PRED_PERCEPTRON_16K: return 64;
+        default:                  return 0;
+    }
+}
+
+static struct perceptron *perceptron_create(int size) {
+    struct perceptron *p = calloc(1, sizeof(struct perceptron));
+    if (!p) return NULL;
+    p->count = size;
+    p->num_weights = size;
+    p->stride = size < 16 ? 16 : size;
+    // training threshold from the perceptron paper: 1.93 * history length + 14
+    p->threshold = (193 * (size - 1)) / 100 + 14;
+    p->weights = calloc((size_t)p->count * p->stride, 1);
+    if (!p->weights) {
+        free(p);
+        return NULL;
+    }
+    return p;
+}
+
+static void perceptron_delete(struct perceptron *p) {
+    if (p) {
+        free(p->weights);
+        free(p);
+    }
+}
+
+static int8_t *perceptron_row(struct perceptron *p, uint32_t pc) {
+    uint32_t pcs = pc >> 2;
+    uint32_t index = (pcs ^ (pcs >> 7) ^ (pcs >> 13)) & (uint32_t)(p->count - 1);
+    return &p->weights[index * (uint32_t)p->stride];
+}
+
+// sum of w[i] * x[i] with x[i] = +1/-1 given as the byte masks in 'inputs':
+// (w ^ m) - m negates w where m is -1
+static int perceptron_output(const struct perceptron *p, const int8_t *w) {
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    for (int i = 0; i < p->stride; i += 16) {
+        __m128i wv = _mm_loadu_si128((const __m128i *)(w + i));
+        __m128i mv = _mm_loadu_si128((const __m128i *)(p->inputs + i));
+        __m128i v = _mm_sub_epi8(_mm_xor_si128(wv, mv), mv);
+        // sign-extend to 16 bits; 64 weights of at most 127 cannot overflow
+        acc = _mm_add_epi16(acc, _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8));
+        acc = _mm_add_epi16(acc, _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8));
+    }
+    acc = _mm_madd_epi16(acc, _mm_set1_epi16(1));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int y = 0;
+    for (int i = 0; i < p->num_weights; i++) {
+        y += (w[i] ^ p->inputs[i]) - p->inputs[i];
+    }
+    return y;
+#endif
+}
+
+static int perceptron_predict(struct perceptron *p, uint32_t pc) {
+    return perceptron_output(p, perceptron_row(p, pc)) >= 0;
+}
+
+static int perceptron_update(struct perceptron *p, uint32_t pc, int taken) {
+    int8_t *w = perceptron_row(p, pc);
+    int y = perceptron_output(p, w);
+    int prediction = y >= 0;
+    if (prediction != taken || abs(y) <= p->threshold) {
+        for (int i = 0; i < p->num_weights; i++) {
+            // move towards the input when taken, away from it when not
+            int agree = (p->inputs[i] == 0) == (taken != 0);
+            if (agree) {
+                if (w[i] < PERCEPTRON_WEIGHT_MAX) w[i]++;
+            } else if (w[i] > -PERCEPTRON_WEIGHT_MAX) {
+                w[i]--;
+            }
+        }
+    }
+    memmove(&p->inputs[2], &p->inputs[1], (size_t)(p->num_weights - 2));
+    p->inputs[1] = taken ? 0 : -1;
+    return prediction;
+}
+
+static int get_history_bits(int table_size);
+
+static void counter_update(uint8_t *counter, int taken) {
+    if (taken) {
+        if (*counter < 3) (*counter)++;
+    } else {
+        if (*counter > 0) (*counter)--;
+    }
+}
+
+// Tournament predictor: the components index their tables exactly like the
+// standalone bimodal and gShare predictors, so their numbers can be compared.
+// The chooser has as many entries as the bimodal table; >= 2 selects gShare.
+struct tournament {
+    uint8_t *bimodal;
+    uint8_t *gshare;
+    uint8_t *chooser;
+    int bimodal_size;
+    int gshare_size;
+    int history_bits;
+    uint32_t global_history;
+    // [0] bimodal, [1] gShare
+    uint64_t chosen[2];
+    uint64_t chosen_correct[2];
+    uint64_t disagreements;
+    uint64_t disagreements_gshare_right;
+};
+
+static void tournament_delete(struct tournament *t) {
+    if (t) {
+        free(t->bimodal);
+        free(t->gshare);
+        free(t->chooser);
+        free(t);
+    }
+}
+
+static struct tournament *tournament_create(int bimodal_size, int gshare_size) {
+    struct tournament *t = calloc(1, sizeof(struct tournament));
+    if (!t) return NULL;
+    t->bimodal_size = bimodal_size;
+    t->gshare_size = gshare_size;
+    t->history_bits = get_history_bits(gshare_size);
+    t->bimodal = malloc(bimodal_size);
+    t->gshare = malloc(gshare_size);
+    t->chooser = malloc(bimodal_size);
+    if (!t->bimodal || !t->gshare || !t->chooser) {
+        tournament_delete(t);
+        return NULL;
+    }
+    memset(t->bimodal, 2, bimodal_size);
+    memset(t->gshare, 2, gshare_size);
+    // start out trusting the bimodal component, which warms up faster
+    memset(t->chooser, 1, bimodal_size);
+    return t;
+}
+
+static uint32_t tournament_gshare_index(const struct tournament *t, uint32_t pc) {
+    uint32_t mask = (1u << t->history_bits) - 1;
+    return (((pc >> 2) & mask) ^ (t->global_history & mask)) % t->gshare_size;
+}
+
+static int tournament_predict(const struct tournament *t, uint32_t pc) {
+    if (t->chooser[(pc >> 2) % t->bimodal_size] >= 2) {
+        return t->gshare[tournament_gshare_index(t, pc)] >= 2;
+    }
+    return t->bimodal[pc % t->bimodal_size] >= 2;
+}
+
+static int tournament_update(struct tournament *t, uint32_t pc, int taken) {
+    uint8_t *bimodal = &t->bimodal[pc % t->bimodal_size];
+    uint8_t *gshare = &t->gshare[tournament_gshare_index(t, pc)];
+    uint8_t *chooser = &t->chooser[(pc >> 2) % t->bimodal_size];
+    int bimodal_pred = *bimodal >= 2;
+    int gshare_pred = *gshare >= 2;
+    int use_gshare = *chooser >= 2;
+    int prediction = use_gshare ? gshare_pred : bimodal_pred;
+
+    t->chosen[use_gshare]++;
+    if (prediction == taken) t->chosen_correct[use_gshare]++;
+    if (bimodal_pred != gshare_pred) {
+        // the chooser only learns when the components disagree
+        t->disagreements++;
+        if (gshare_pred == taken) t->disagreements_gshare_right++;
+        counter_update(chooser, gshare_pred == taken);
+    }
+    counter_update(bimodal, taken);
+    counter_update(gshare, taken);
+    t->global_history = ((t->global_history << 1) | (taken ? 1 : 0)) & ((1u << t->history_bits) - 1);
+    return prediction;
+}
+
+static void tournament_print_stats(const struct tournament *t) {
+    const char *names[2] = { "Bimodal", "gShare" };
+    printf("Components: bimodal %d entries, gShare %d entries, chooser %d entries\n",
+           t->bimodal_size, t->gshare_size, t->bimodal_size);
+    for (int c = 0; c < 2; c++) {
+        printf("%s chosen: %lu (%lu correct", names[c], t->chosen[c], t->chosen_correct[c]);
+        if (t->chosen[c] > 0) {
+            printf(", %.2f%%", 100.0 * t->chosen_correct[c] / t->chosen[c]);
+        }
+        printf(")\n");
+    }
+    printf("Components disagreed: %lu (gShare right %lu, bimodal right %lu)\n", t->disagreements,
+           t->disagreements_gshare_right, t->disagreements - t->disagreements_gshare_right);
+}
+
+// Two-level local-history predictors. The first level holds branch histories,
+// one per branch address (PAg, PAp) or one per set of branches (SAg, a set being
+// the branches in a 64-byte block of code). The history indexes a pattern table
+// of 2-bit counters shared by all branches (g) or private to each first-level
+// entry (p).
+#define SAG_SET_SHIFT 6
+
+struct local_predictor {
+    predictor_type_t type;
+    uint16_t *histories;
+    uint8_t *patterns;
+    int history_entries;
+    int pattern_entries;
+    int history_bits;
+};
+
+static void local_delete(struct local_predictor *l) {
+    if (l) {
+        free(l->histories);
+        free(l->patterns);
+        free(l);
+    }
+}
+
+static struct local_predictor *local_create(predictor_type_t type, int history_entries, int pattern_entries) {
+    struct local_predictor *l = calloc(1, sizeof(struct local_predictor));
+    if (!l) return NULL;
+    l->type = type;
+    l->history_entries = history_entries;
+    l->pattern_entries = pattern_entries;
+    l->history_bits = get_history_bits(pattern_entries);
+    size_t counters = (size_t)pattern_entries * (type == PRED_PAP ? history_entries : 1);
+    l->histories = calloc(history_entries, sizeof(uint16_t));
+    l->patterns = malloc(counters);
+    if (!l->histories || !l->patterns) {
+        local_delete(l);
+        return NULL;
+    }
+    memset(l->patterns, 2, counters);
+    return l;
+}
+
+static uint32_t local_history_index(const struct local_predictor *l, uint32_t pc) {
+    uint32_t shift = l->type == PRED_SAG ? SAG_SET_SHIFT : 2;
+    return (pc >> shift) & (uint32_t)(l->history_entries - 1);
+}
+
+static uint8_t *local_counter(const struct local_predictor *l, uint32_t history_index) {
+    size_t index = l->histories[history_index];
+    if (l->type == PRED_PAP) {
+        index += (size_t)history_index * l->pattern_entries;
+    }
+    return &l->patterns[index];
+}
+
+static int local_predict(const struct local_predictor *l, uint32_t pc) {
+    return *local_counter(l, local_history_index(l, pc)) >= 2;
+}
+
+static int local_update(struct local_predictor *l, uint32_t pc, int taken) {
+    uint32_t history_index = local_history_index(l, pc);
+    uint8_t *counter = local_counter(l, history_index);
+    int prediction = *counter >= 2;
+    counter_update(counter, taken);
+    uint16_t *history = &l->histories[history_index];
+    *history = (uint16_t)(((*history << 1) | (taken ? 1 : 0)) & (l->pattern_entries - 1));
+    return prediction;
+}
+
+static void local_print_stats(const struct local_predictor *l) {
+    int tables = l->type == PRED_PAP ? l->history_entries : 1;
+    long bits = (long)l->history_entries * l->history_bits + 2L * tables * l->pattern_entries;
+    printf("Histories: %d x %d bits, pattern tables: %d x %d counters\n",
+           l->history_entries, l->history_bits, tables, l->pattern_entries);
+    printf("Storage: %ld bits\n", bits);
+}
+
+// Predictors that separate branches to reduce destructive aliasing in a
+// gShare-indexed table. At each size point they use as many 2-bit counters as
+// the gShare predictor of that size; agree and YAGS need storage beyond them:
+//   bi-mode: choice table (N/2, by PC) selects one of two direction tables
+//            (N/4 each, gShare index) biased towards taken / not taken
+//   agree:   N gShare indexed counters predicting whether the branch agrees
+//            with its bias bit, plus N/4 bias bits (by PC, set by the first
+//            outcome; the paper keeps them in the BTB)
+//   YAGS:    choice table (N/2) plus two tagged caches (N/4 each, 6-bit tags)
+//            holding only the exceptions to the choice: the taken cache is
+//            consulted when the choice says not taken, and vice versa
+#define YAGS_TAG_BITS 6
+#define YAGS_VALID 0x80
+
+typedef enum { DEALIAS_BIMODE, DEALIAS_AGREE, DEALIAS_YAGS } dealias_kind_t;
+
+struct dealiased {
+    dealias_kind_t kind;
+    int size;
+    uint8_t *choice;            // bi-mode/YAGS choice counters, agree bias bits
+    int choice_entries;
+    uint8_t *direction[2];      // [0] not taken / [1] taken biased; agree uses [0] only
+    uint8_t *tags[2];           // YAGS only
+    int direction_entries;
+    int history_bits;
+    uint32_t global_history;
+    int alias_choice, alias_direction[2];   // table ids in pred->aliasing
+};
+
+static int get_dealiased_size(predictor_type_t type, dealias_kind_t *kind) {
+    if (type >= PRED_BIMODE_256 && type <= PRED_BIMODE_16K) *kind = DEALIAS_BIMODE;
+    else if (type >= PRED_AGREE_256 && type <= PRED_AGREE_16K) *kind = DEALIAS_AGREE;
+    else if (type >= PRED_YAGS_256 && type <= PRED_YAGS_16K) *kind = DEALIAS_YAGS;
+    else return 0;
+    // the three families list the same four size points in order
+    static const int sizes[4] = { 256, 1024, 4096, 16384 };
+    int first = *kind == DEALIAS_BIMODE ? PRED_BIMODE_256
+              : *kind == DEALIAS_AGREE ? PRED_AGREE_256 : PRED_YAGS_256;
+    return sizes[type - first];
+}
+
+static void dealiased_delete(struct dealiased *d) {
+    if (d) {
+        free(d->choice);
+        for (int i = 0; i < 2; i++) {
+            free(d->direction[i]);
+            free(d->tags[i]);
+        }
+        free(d);
+    }
+}
+
+static struct dealiased *dealiased_create(dealias_kind_t kind, int size) {
+    struct dealiased *d = calloc(1, sizeof(struct dealiased));
+    if (!d) return NULL;
+    d->kind = kind;
+    d->size = size;
+    int tables = kind == DEALIAS_AGREE ? 1 : 2;
+    d->choice_entries = kind == DEALIAS_AGREE ? size / 4 : size / 2;
+    d->direction_entries = kind == DEALIAS_AGREE ? size : size / 4;
+    d->history_bits = get_history_bits(d->direction_entries);
+    d->choice = malloc(d->choice_entries);
+    int ok = d->choice != NULL;
+    for (int i = 0; i < tables; i++) {
+        d->direction[i] = malloc(d->direction_entries);
+        ok = ok && d->direction[i];
+        if (kind == DEALIAS_YAGS) {
+            d->tags[i] = calloc(d->direction_entries, 1);
+            ok = ok && d->tags[i];
+        }
+    }
+    if (!ok) {
+        dealiased_delete(d);
+        return NULL;
+    }
+    // agree: bias bits start out as taken, and counters as weakly agreeing
+    memset(d->choice, kind == DEALIAS_AGREE ? 1 : 2, d->choice_entries);
+    for (int i = 0; i < tables; i++) {
+        // bi-mode direction tables start weakly in their own direction
+        memset(d->direction[i], (kind == DEALIAS_BIMODE && i == 0) ? 1 : 2, d->direction_entries);
+    }
+    return d;
+}
+
+static uint32_t dealiased_direction_index(const struct dealiased *d, uint32_t pc) {
+    uint32_t mask = (1u << d->history_bits) - 1;
+    return ((pc >> 2) ^ d->global_history) & mask;
+}
+
+static uint8_t yags_tag(uint32_t pc) {
+    return (uint8_t)(YAGS_VALID | ((pc >> 2) & ((1u << YAGS_TAG_BITS) - 1)));
+}
+
+// Everything one prediction looked at, shared by predict and update.
+struct dealiased_lookup {
+    uint32_t choice_index;
+    uint32_t direction_index;
+    int choice_pred;
+    int table;                  // direction table used, -1 if none (YAGS miss)
+    int prediction;
+};
+
+static void dealiased_lookup(const struct dealiased *d, uint32_t pc, struct dealiased_lookup *l) {
+    l->choice_index = (pc >> 2) % d->choice_entries;
+    l->direction_index = dealiased_direction_index(d, pc);
+    switch (d->kind) {
+        case DEALIAS_BIMODE:
+            l->choice_pred = d->choice[l->choice_index] >= 2;
+            l->table = l->choice_pred;
+            l->prediction = d->direction[l->table][l->direction_index] >= 2;
+            break;
+        case DEALIAS_AGREE: {
+            int bias = d->choice[l->choice_index] & 1;
+            int agree = d->direction[0][l->direction_index] >= 2;
+            l->choice_pred = bias;
+            l->table = 0;
+            l->prediction = agree ? bias : !bias;
+            break;
+        }
+        case DEALIAS_YAGS:
+            l->choice_pred = d->choice[l->choice_index] >= 2;
+            // look for an exception to the choice
+            l->table = !l->choice_pred;
+            if (d->tags[l->table][l->direction_index] == yags_tag(pc)) {
+                l->prediction = d->direction[l->table][l->direction_index] >= 2;
+            } else {
+                l->table = -1;
+                l->prediction = l->choice_pred;
+            }
+            break;
+    }
+}
+
+static int dealiased_predict(const struct dealiased *d, uint32_t pc) {
+    struct dealiased_lookup l;
+    dealiased_lookup(d, pc, &l);
+    return l.prediction;
+}
+
+static int dealiased_update(struct dealiased *d, struct aliasing *aliasing, uint32_t pc, int taken) {
+    struct dealiased_lookup l;
+    dealiased_lookup(d, pc, &l);
+    if (aliasing) {
+        if (l.table >= 0) {
+            aliasing_observe(aliasing, d->alias_direction[l.table], l.direction_index, pc,
+                             d->global_history, l.prediction, taken);
+        } else {
+            aliasing_observe(aliasing, d->alias_choice, l.choice_index, pc, 0, l.prediction, taken);
+        }
+    }
+    switch (d->kind) {
+        case DEALIAS_BIMODE:
+            counter_update(&d->direction[l.table][l.direction_index], taken);
+            // keep the choice when it was wrong but the direction table was right
+            if (!(l.choice_pred != taken && l.prediction == taken)) {
+                counter_update(&d->choice[l.choice_index], taken);
+            }
+            break;
+        case DEALIAS_AGREE: {
+            uint8_t *bias = &d->choice[l.choice_index];
+            // the first outcome of a branch sets its bias (bit 1 marks it as set)
+            if (!(*bias & 2)) {
+                *bias = (uint8_t)(2 | (taken ? 1 : 0));
+            }
+            counter_update(&d->direction[0][l.direction_index], taken == (*bias & 1));
+            break;
+        }
+        case DEALIAS_YAGS: {
+            int exception = !l.choice_pred;
+            if (l.table >= 0) {
+                counter_update(&d->direction[l.table][l.direction_index], taken);
+            } else if (l.choice_pred != taken) {
+                // the choice was wrong: remember the exception
+                d->tags[exception][l.direction_index] = yags_tag(pc);
+                d->direction[exception][l.direction_index] = taken ? 2 : 1;
+            }
+            if (!(l.choice_pred != taken && l.table >= 0 && l.prediction == taken)) {
+                counter_update(&d->choice[l.choice_index], taken);
+            }
+            break;
+        }
+    }
+    d->global_history = ((d->global_history << 1) | (taken ? 1 : 0)) & ((1u << d->history_bits) - 1);
+    return l.prediction;
+}
+
+static int dealiased_enable_aliasing(struct dealiased *d, struct aliasing *aliasing) {
+    static const char *direction_names[3][2] = {
+        { "not-taken", "taken" }, { "agree", "" }, { "NT-cache", "T-cache" }
+    };
+    // only YAGS predicts from the choice table (when both caches miss)
+    d->alias_choice = d->kind == DEALIAS_YAGS
+        ? aliasing_add_table(aliasing, "choice", (uint32_t)d->choice_entries, 2) : 0;
+    int tables = d->kind == DEALIAS_AGREE ? 1 : 2;
+    for (int i = 0; i < tables; i++) {
+        d->alias_direction[i] = aliasing_add_table(aliasing, direction_names[d->kind][i],
+                                                   (uint32_t)d->direction_entries, 2);
+        if (d->alias_direction[i] < 0) return -1;
+    }
+    return d->alias_choice < 0 ? -1 : 0;
+}
+
+static void dealiased_report_counters(const struct dealiased *d, struct aliasing *aliasing) {
+    if (d->kind == DEALIAS_YAGS) {
+        for (int e = 0; e < d->choice_entries; e++) {
+            aliasing_set_counter(aliasing, d->alias_choice, (uint32_t)e, d->choice[e]);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!d->direction[i]) continue;
+        for (int e = 0; e < d->direction_entries; e++) {
+            aliasing_set_counter(aliasing, d->alias_direction[i], (uint32_t)e, d->direction[i][e]);
+        }
+    }
+}
+
 static int get_history_bits(int table_size) {
     int bits = 0;
     int size = table_size;
@@ -31,7 +555,106 @@ static int get_history_bits(int table_size) {
     return bits;
 }
 
-branch_predictor_t* predictor_create(predictor_type_t type) {
+static void select_kernel(branch_predictor_t *pred);
+static const predictor_ops_t *family_ops(predictor_type_t type);
+
+// Index functions, one per predictor_hash_t. pred->global_history only holds
+// history_bits bits, so it is 0 for bimodal.
+static uint32_t fold(uint64_t value, int bits) {
+    uint32_t folded = 0;
+    for (; value; value >>= bits) {
+        folded ^= (uint32_t)value & ((1u << bits) - 1);
+    }
+    return folded;
+}
+
+static uint32_t index_xor(const branch_predictor_t *pred, uint32_t pc) {
+    uint32_t index = (pc >> pred->config.pc_shift) ^ (uint32_t)pred->global_history;
+    return index & ((uint32_t)pred->table_size - 1);
+}
+
+static uint32_t index_fold(const branch_predictor_t *pred, uint32_t pc) {
+    uint32_t index = (pc >> pred->config.pc_shift) ^ fold(pred->global_history, pred->index_bits);
+    return index & ((uint32_t)pred->table_size - 1);
+}
+
+static uint32_t index_pcfold(const branch_predictor_t *pred, uint32_t pc) {
+    return fold(pc >> pred->config.pc_shift, pred->index_bits) ^ fold(pred->global_history, pred->index_bits);
+}
+
+static uint32_t index_mult(const branch_predictor_t *pred, uint32_t pc) {
+    uint64_t key = (uint64_t)(pc >> pred->config.pc_shift) ^ pred->global_history;
+    return (uint32_t)((key * 0x9e3779b97f4a7c15ull) >> (64 - pred->index_bits));
+}
+
+static uint32_t index_gselect(const branch_predictor_t *pred, uint32_t pc) {
+    uint32_t index = ((pc >> pred->config.pc_shift) << pred->history_bits) | (uint32_t)pred->global_history;
+    return index & ((uint32_t)pred->table_size - 1);
+}
+
+static uint32_t (*const index_functions[])(const branch_predictor_t *, uint32_t) = {
+    index_xor, index_fold, index_pcfold, index_mult, index_gselect
+};
+static const char *hash_names[] = { "xor", "fold", "pcfold", "mult", "gselect" };
+
+static int init_table(branch_predictor_t *pred, const predictor_config_t *config) {
+    pred->config = *config;
+    pred->slot_shift = 0;
+    while ((1 << pred->slot_shift) < config->counter_bits) {
+        pred->slot_shift++;
+    }
+    int slot_bits = 1 << pred->slot_shift;
+    int slots_per_word = 64 >> pred->slot_shift;
+    size_t words = ((size_t)config->entries + slots_per_word - 1) / slots_per_word;
+    pred->table = (uint64_t*)malloc(words * sizeof(uint64_t));
+    if (!pred->table) return -1;
+    pred->table_size = config->entries;
+    pred->index_bits = get_history_bits(config->entries);
+    pred->index_fn = index_functions[config->hash];
+    pred->history_bits = config->type == PRED_GSHARE ? config->history_bits : 0;
+    // weakly taken in every slot
+    uint64_t word = 0;
+    for (int i = 0; i < slots_per_word; i++) {
+        word |= (uint64_t)(1u << (config->counter_bits - 1)) << (i * slot_bits);
+    }
+    for (size_t i = 0; i < words; i++) {
+        pred->table[i] = word;
+    }
+    select_kernel(pred);
+    return 0;
+}
+
+static inline unsigned counter_get(const branch_predictor_t *pred, uint32_t index) {
+    int shift = pred->slot_shift;
+    uint64_t word = pred->table[index >> (6 - shift)];
+    int offset = (int)(index & ((64u >> shift) - 1)) << shift;
+    return (unsigned)(word >> offset) & ((1u << (1 << shift)) - 1);
+}
+
+static inline void counter_set(branch_predictor_t *pred, uint32_t index, unsigned value) {
+    int shift = pred->slot_shift;
+    uint64_t *word = &pred->table[index >> (6 - shift)];
+    int offset = (int)(index & ((64u >> shift) - 1)) << shift;
+    uint64_t mask = ((1ull << (1 << shift)) - 1) << offset;
+    *word = (*word & ~mask) | ((uint64_t)value << offset);
+}
+
+static int counter_taken(const branch_predictor_t *pred, unsigned counter) {
+    return counter >= (1u << (pred->config.counter_bits - 1));
+}
+
+// A predict followed by the update of the same branch hashes only once.
+static uint32_t table_index(branch_predictor_t *pred, uint32_t pc) {
+    if (pc != pred->index_pc || pred->global_history != pred->index_history) {
+        pred->index_pc = pc;
+        pred->index_history = pred->global_history;
+        pred->index = pred->index_fn(pred, pc);
+    }
+    return pred->index;
+}
+
+branch_predictor_t* predictor_create_family(predictor_type_t type, const predictor_ops_t *ops,
+                                            const void *params) {
     branch_predictor_t *pred = (branch_predictor_t*)malloc(sizeof(branch_predictor_t));
     if (!pred) return NULL;
     
@@ -43,136 +666,1008 @@ branch_predictor_t* predictor_create(predictor_type_t type) {
     pred->table_size = 0;
     pred->global_history = 0;
     pred->history_bits = 0;
-    
+    pred->index_bits = 0;
+    memset(&pred->config, 0, sizeof(pred->config));
+    pred->index_fn = NULL;
+    pred->index_pc = 1;         // no branch has an odd pc, so nothing is cached
+    pred->index_history = 0;
+    pred->index = 0;
+    pred->state = NULL;
+    pred->aliasing = NULL;
+    pred->profile = NULL;
+    pred->observed_update = NULL;
+    pred->recording = NULL;
+    pred->analysis = NULL;
+    pred->ops = ops;
+    pred->update = ops->update;
+    if (ops->create) {
+        pred->state = ops->create(pred, params);
+        if (!pred->state) {
+            free(pred);
+            return NULL;
+        }
+    }
+    return pred;
+}
+
+branch_predictor_t* predictor_create(predictor_type_t type) {
+    branch_predictor_t *pred = predictor_create_family(type, family_ops(type), NULL);
+    if (!pred) return NULL;
+
     int table_size = get_table_size(type);
     if (table_size > 0) {
-        pred->table = (uint8_t*)malloc(table_size);
-        if (!pred->table) {
+        // the fixed sizes: bimodal indexes with the full pc, gShare with pc >> 2
+        // and as many history bits as index bits
+        int gshare = type >= PRED_GSHARE_256 && type <= PRED_GSHARE_16K;
+        predictor_config_t config = {
+            gshare ? PRED_GSHARE : PRED_BIMODAL, table_size,
+            gshare ? get_history_bits(table_size) : 0, 2, gshare ? 2 : 0, PREDICTOR_HASH_XOR
+        };
+        if (init_table(pred, &config)) {
             free(pred);
             return NULL;
         }
-        pred->table_size = table_size;
-        
-        memset(pred->table, 2, table_size);
-        
-        if (type >= PRED_GSHARE_256 && type <= PRED_GSHARE_16K) {
-            pred->history_bits = get_history_bits(table_size);
-        }
     }
     
     return pred;
 }
 
+static int is_power_of_two(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+branch_predictor_t* predictor_create_config(const predictor_config_t *config) {
+    if (config->type != PRED_BIMODAL && config->type != PRED_GSHARE) {
+        return NULL;
+    }
+    branch_predictor_t *pred = predictor_create(config->type);
+    if (!pred) return NULL;
+    if (init_table(pred, config)) {
+        predictor_destroy(pred);
+        return NULL;
+    }
+    return pred;
+}
+
+predictor_type_t predictor_parse_type(const char *str) {
+    if (strcmp(str, "NT") == 0) return PRED_NT;
+    if (strcmp(str, "BTFNT") == 0) return PRED_BTFNT;
+    if (strcmp(str, "bimodal-256") == 0) return PRED_BIMODAL_256;
+    if (strcmp(str, "bimodal-1K") == 0) return PRED_BIMODAL_1K;
+    if (strcmp(str, "bimodal-4K") == 0) return PRED_BIMODAL_4K;
+    if (strcmp(str, "bimodal-16K") == 0) return PRED_BIMODAL_16K;
+    if (strcmp(str, "gshare-256") == 0) return PRED_GSHARE_256;
+    if (strcmp(str, "gshare-1K") == 0) return PRED_GSHARE_1K;
+    if (strcmp(str, "gshare-4K") == 0) return PRED_GSHARE_4K;
+    if (strcmp(str, "gshare-16K") == 0) return PRED_GSHARE_16K;
+    if (strcmp(str, "tage-sc-l-8K") == 0) return PRED_TAGE_SC_L_8K;
+    if (strcmp(str, "tage-sc-l-32K") == 0) return PRED_TAGE_SC_L_32K;
+    if (strcmp(str, "tage-sc-l-64K") == 0) return PRED_TAGE_SC_L_64K;
+    if (strcmp(str, "perceptron-256") == 0) return PRED_PERCEPTRON_256;
+    if (strcmp(str, "perceptron-1K") == 0) return PRED_PERCEPTRON_1K;
+    if (strcmp(str, "perceptron-4K") == 0) return PRED_PERCEPTRON_4K;
+    if (strcmp(str, "perceptron-16K") == 0) return PRED_PERCEPTRON_16K;
+    if (strcmp(str, "bimode-256") == 0) return PRED_BIMODE_256;
+    if (strcmp(str, "bimode-1K") == 0) return PRED_BIMODE_1K;
+    if (strcmp(str, "bimode-4K") == 0) return PRED_BIMODE_4K;
+    if (strcmp(str, "bimode-16K") == 0) return PRED_BIMODE_16K;
+    if (strcmp(str, "agree-256") == 0) return PRED_AGREE_256;
+    if (strcmp(str, "agree-1K") == 0) return PRED_AGREE_1K;
+    if (strcmp(str, "agree-4K") == 0) return PRED_AGREE_4K;
+    if (strcmp(str, "agree-16K") == 0) return PRED_AGREE_16K;
+    if (strcmp(str, "yags-256") == 0) return PRED_YAGS_256;
+    if (strcmp(str, "yags-1K") == 0) return PRED_YAGS_1K;
+    if (strcmp(str, "yags-4K") == 0) return PRED_YAGS_4K;
+    if (strcmp(str, "yags-16K") == 0) return PRED_YAGS_16K;
+    return PRED_NONE;
+}
+
+// "1024", "64K", "1M"
+static int parse_count(const char *str, int *value) {
+    char *end;
+    long n = strtol(str, &end, 10);
+    if (end == str || n < 0) return -1;
+    if (*end == 'K') n *= 1024, end++;
+    else if (*end == 'M') n *= 1024 * 1024, end++;
+    if (*end != '\0' || n > (1L << 30)) return -1;
+    *value = (int)n;
+    return 0;
+}
+
+int predictor_parse_spec(const char *spec, predictor_config_t *config) {
+    char buf[256];
+    if (strlen(spec) >= sizeof(buf)) return -1;
+    strcpy(buf, spec);
+    char *params = strchr(buf, ':');
+    if (params) *params++ = '\0';
+
+    if (!strcmp(buf, "bimodal")) {
+        predictor_config_t defaults = { PRED_BIMODAL, 1024, 0, 2, 0, PREDICTOR_HASH_XOR };
+        *config = defaults;
+    } else if (!strcmp(buf, "gshare")) {
+        predictor_config_t defaults = { PRED_GSHARE, 1024, -1, 2, 2, PREDICTOR_HASH_XOR };
+        *config = defaults;
+    } else {
+        return -1;
+    }
+
+    char *save = NULL;
+    for (char *param = params ? strtok_r(params, ",", &save) : NULL; param;
+         param = strtok_r(NULL, ",", &save)) {
+        char *value = strchr(param, '=');
+        if (!value) return -1;
+        *value++ = '\0';
+        if (!strcmp(param, "entries")) {
+            if (parse_count(value, &config->entries)) return -1;
+        } else if (!strcmp(param, "hist") && config->type == PRED_GSHARE) {
+            if (parse_count(value, &config->history_bits)) return -1;
+        } else if (!strcmp(param, "ctr")) {
+            if (parse_count(value, &config->counter_bits)) return -1;
+        } else if (!strcmp(param, "index")) {
+            if (!strcmp(value, "pc")) config->pc_shift = 0;
+            else if (!strncmp(value, "pc>>", 4)) {
+                if (parse_count(value + 4, &config->pc_shift)) return -1;
+            }
+            else return -1;
+        } else if (!strcmp(param, "hash")) {
+            unsigned h = 0;
+            while (h < sizeof(hash_names) / sizeof(hash_names[0]) && strcmp(value, hash_names[h])) h++;
+            if (h == sizeof(hash_names) / sizeof(hash_names[0])) return -1;
+            config->hash = (predictor_hash_t)h;
+        } else {
+            return -1;
+        }
+    }
+    // gShare defaults to as many history bits as index bits
+    if (config->history_bits < 0) {
+        config->history_bits = get_history_bits(config->entries);
+    }
+    if (config->entries < 2 || (config->entries & (config->entries - 1))
+        || config->history_bits > 64 || config->counter_bits < 1 || config->counter_bits > 8
+        || config->pc_shift > 31
+        || (config->hash == PREDICTOR_HASH_GSELECT && config->history_bits >= get_history_bits(config->entries))) {
+        return -1;
+    }
+    return 0;
+}
+
+// "<count>-<count>" after a predictor name prefix, e.g. the "1K-4K" in tournament-1K-4K
+static int parse_two_counts(const char *str, int *first, int *second) {
+    char buf[64];
+    if (strlen(str) >= sizeof(buf)) return -1;
+    strcpy(buf, str);
+    char *dash = strchr(buf, '-');
+    if (!dash) return -1;
+    *dash = '\0';
+    return parse_count(buf, first) || parse_count(dash + 1, second) ? -1 : 0;
+}
+
+// Copies the text up to 'separator' ('\0' for none) of 'str' into 'buf'; returns
+// the rest after the separator, "" if there is none, and NULL if the text is
+// empty or too long.
+static const char *split_field(const char *str, char separator, char *buf, size_t size) {
+    const char *end = separator ? strchr(str, separator) : NULL;
+    size_t length = end ? (size_t)(end - str) : strlen(str);
+    if (length == 0 || length >= size) return NULL;
+    memcpy(buf, str, length);
+    buf[length] = '\0';
+    return end ? end + 1 : "";
+}
+
+static int has_prefix(const char *str, const char *prefix) {
+    return strncmp(str, prefix, strlen(prefix)) == 0;
+}
+
+// "profile:FILE" and "oracle:FILE[:H]"
+static branch_predictor_t *create_bound_named(const char *name) {
+    char file_name[256];
+    predictor_type_t type = has_prefix(name, "profile:") ? PRED_PROFILE_STATIC : PRED_ORACLE;
+    const char *bits = split_field(strchr(name, ':') + 1, type == PRED_ORACLE ? ':' : '\0',
+                                   file_name, sizeof(file_name));
+    if (!bits) {
+        printf("Invalid outcome profile file name: %s\n", name);
+        return NULL;
+    }
+    int history_bits = -1;
+    if (*bits && (parse_count(bits, &history_bits) || history_bits > 64)) {
+        printf("Invalid number of history bits: %s\n", bits);
+        return NULL;
+    }
+    branch_predictor_t *pred = predictor_create_bound(type, file_name, history_bits);
+    if (!pred) {
+        printf("Could not use outcome profile %s\n", file_name);
+    }
+    return pred;
+}
+
+// "plugin:PATH.so[:ARGS]"
+static branch_predictor_t *create_plugin_named(const char *name) {
+    char path[256];
+    const char *spec = name + strlen("plugin:");
+    const char *args = strchr(spec, ':');
+    if (!split_field(spec, ':', path, sizeof(path))) {
+        printf("Invalid plugin path: %s\n", name);
+        return NULL;
+    }
+    return predictor_create_plugin(path, args ? args + 1 : NULL);
+}
+
+branch_predictor_t* predictor_create_named(const char *name) {
+    static const struct { const char *prefix; predictor_type_t type; } local_types[] = {
+        { "pag-", PRED_PAG }, { "pap-", PRED_PAP }, { "sag-", PRED_SAG }
+    };
+    predictor_type_t type = predictor_parse_type(name);
+    if (type != PRED_NONE) {
+        branch_predictor_t *pred = predictor_create(type);
+        if (!pred) printf("Could not create predictor %s\n", name);
+        return pred;
+    }
+    if (has_prefix(name, "plugin:")) return create_plugin_named(name);
+    if (has_prefix(name, "profile:") || has_prefix(name, "oracle:")) return create_bound_named(name);
+
+    // the predictors whose name carries their sizes
+    branch_predictor_t *pred = NULL;
+    int first, second;
+    int sized = 1;
+    if (has_prefix(name, "tage-sc-l-")) {
+        if (parse_count(name + strlen("tage-sc-l-"), &first) == 0 && first % 1024 == 0) {
+            pred = predictor_create_tage(first / 1024);
+        }
+    } else if (has_prefix(name, "tournament-")) {
+        if (parse_two_counts(name + strlen("tournament-"), &first, &second) == 0) {
+            pred = predictor_create_tournament(first, second);
+        }
+    } else {
+        sized = 0;
+        for (unsigned i = 0; i < sizeof(local_types) / sizeof(local_types[0]); i++) {
+            if (has_prefix(name, local_types[i].prefix)) {
+                sized = 1;
+                if (parse_two_counts(name + strlen(local_types[i].prefix), &first, &second) == 0) {
+                    pred = predictor_create_local(local_types[i].type, first, second);
+                }
+            }
+        }
+    }
+    if (sized) {
+        if (!pred) printf("Invalid sizes or could not create predictor %s\n", name);
+        return pred;
+    }
+
+    predictor_config_t config;
+    if (predictor_parse_spec(name, &config) == 0) {
+        pred = predictor_create_config(&config);
+        if (!pred) printf("Could not create predictor %s\n", name);
+        return pred;
+    }
+    printf("Unknown predictor type: %s\n", name);
+    return NULL;
+}
+
+int predictor_enable_aliasing(branch_predictor_t *pred) {
+    if (!pred->ops->enable_aliasing) return -1;
+    pred->aliasing = aliasing_create();
+    if (!pred->aliasing) return -1;
+    if (pred->ops->enable_aliasing(pred)) {
+        aliasing_delete(pred->aliasing);
+        pred->aliasing = NULL;
+        return -1;
+    }
+    select_kernel(pred);
+    return 0;
+}
+
 void predictor_destroy(branch_predictor_t *pred) {
     if (pred) {
-        if (pred->table) {
-            free(pred->table);
+        if (pred->ops->destroy) {
+            pred->ops->destroy(pred);
+        }
+        if (pred->aliasing) {
+            aliasing_delete(pred->aliasing);
         }
+        branch_profile_delete(pred->profile);
+        outcome_profile_delete(pred->recording);
+        branch_analysis_delete(pred->analysis);
         free(pred);
     }
 }
 
 int predictor_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
-    if (!pred || pred->type == PRED_NONE) {
+    if (!pred) {
         return 0;
     }
-    
-    switch (pred->type) {
-        case PRED_NT:
-            return 0;
-            
-        case PRED_BTFNT:
-            return (target < pc) ? 1 : 0;
-            
-        case PRED_BIMODAL_256:
-        case PRED_BIMODAL_1K:
-        case PRED_BIMODAL_4K:
-        case PRED_BIMODAL_16K: {
-            int index = pc % pred->table_size;
-            uint8_t counter = pred->table[index];
-            return (counter >= 2) ? 1 : 0;
+    return pred->ops->predict(pred, pc, target);
+}
+
+static void count_outcome(branch_predictor_t *pred, int prediction, int taken) {
+    pred->stats.total_branches++;
+    if (prediction != taken) {
+        pred->stats.mispredictions++;
+    }
+}
+
+// NT, BTFNT and the "None" predictor, which predicts not taken
+static int static_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    return pred->type == PRED_BTFNT && target < pc;
+}
+
+static void static_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    count_outcome(pred, static_predict(pred, pc, target), taken);
+}
+
+static int table_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return counter_taken(pred, counter_get(pred, table_index(pred, pc)));
+}
+
+// 'history' is the global history the index was computed with
+static void train_counter(branch_predictor_t *pred, uint32_t index, uint32_t pc, uint64_t history, int taken) {
+    unsigned counter = counter_get(pred, index);
+    if (pred->aliasing) {
+        aliasing_observe(pred->aliasing, 0, index, pc, history, counter_taken(pred, counter), taken);
+    }
+    if (taken) {
+        if (counter < (1u << pred->config.counter_bits) - 1) {
+            counter_set(pred, index, counter + 1);
+        }
+    } else {
+        if (counter > 0) {
+            counter_set(pred, index, counter - 1);
         }
-            
-        case PRED_GSHARE_256:
-        case PRED_GSHARE_1K:
-        case PRED_GSHARE_4K:
-        case PRED_GSHARE_16K: {
-            int index_bits = pred->history_bits;
-            uint32_t pc_bits = (pc >> 2) & ((1 << index_bits) - 1);
-            uint32_t hist_bits = pred->global_history & ((1 << index_bits) - 1);
-            int index = (pc_bits ^ hist_bits) % pred->table_size;
-            uint8_t counter = pred->table[index];
-            return (counter >= 2) ? 1 : 0;
-        }
-            
-        default:
-            return 0;
     }
 }
 
-void predictor_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
-    if (!pred || pred->type == PRED_NONE) {
-        return;
+static void shift_history(branch_predictor_t *pred, int taken) {
+    if (pred->history_bits > 0) {
+        pred->global_history = (pred->global_history << 1) | (taken ? 1 : 0);
+        if (pred->history_bits < 64) {
+            pred->global_history &= (1ull << pred->history_bits) - 1;
+        }
     }
+}
 
-    int prediction = predictor_predict(pred, pc, target);
+static void table_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    uint32_t index = table_index(pred, pc);
+    (void)target;
+    count_outcome(pred, counter_taken(pred, counter_get(pred, index)), taken);
+    train_counter(pred, index, pc, pred->global_history, taken);
+    shift_history(pred, taken);
+}
 
-    pred->stats.total_branches++;
-    if (prediction != taken) {
-        pred->stats.mispredictions++;
+// Pipelined operation: counters are written when a branch commits, 'depth'
+// branches after it was predicted, so a prediction does not see the updates of
+// the branches still in flight. Only correct-path branches are simulated: a
+// misprediction flushes the younger branches, which are fetched again with the
+// repaired history, so the global history always holds the actual outcomes and
+// the loss against immediate update comes from the delayed counter updates.
+// The pipeline is the state of the bimodal/gShare family (pred->state, NULL
+// for immediate update).
+struct in_flight {
+    uint32_t pc;
+    uint32_t index;
+    uint64_t history;           // history used for the index
+    int taken;
+};
+
+struct pipeline {
+    int depth;
+    struct in_flight *queue;    // ring of depth + 1 entries
+    int head;
+    int count;
+    uint16_t *pending;          // updates in flight per counter
+    uint64_t stale_reads;       // predictions from a counter with an update in flight
+};
+
+static void retire_oldest(branch_predictor_t *pred) {
+    struct pipeline *p = pred->state;
+    struct in_flight *b = &p->queue[p->head];
+    train_counter(pred, b->index, b->pc, b->history, b->taken);
+    p->pending[b->index]--;
+    p->head = (p->head + 1) % (p->depth + 1);
+    p->count--;
+}
+
+static void table_update_pipelined(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    struct pipeline *p = pred->state;
+    uint32_t index = table_index(pred, pc);
+    (void)target;
+    count_outcome(pred, counter_taken(pred, counter_get(pred, index)), taken);
+    if (p->pending[index]++) {
+        p->stale_reads++;
+    }
+    struct in_flight *b = &p->queue[(p->head + p->count) % (p->depth + 1)];
+    b->pc = pc;
+    b->index = index;
+    b->history = pred->global_history;
+    b->taken = taken;
+    p->count++;
+    shift_history(pred, taken);
+    if (p->count > p->depth) {
+        retire_oldest(pred);
     }
+}
 
-    switch (pred->type) {
-        case PRED_BIMODAL_256:
-        case PRED_BIMODAL_1K:
-        case PRED_BIMODAL_4K:
-        case PRED_BIMODAL_16K: {
-            int index = pc % pred->table_size;
-            uint8_t *counter = &pred->table[index];
-            
-            if (taken) {
-                if (*counter < 3) {
-                    (*counter)++;
-                }
-            } else {
-                if (*counter > 0) {
-                    (*counter)--;
-                }
-            }
-            break;
+int predictor_enable_pipeline(branch_predictor_t *pred, int depth) {
+    if (!pred->table || pred->state || depth < 0 || depth > PREDICTOR_MAX_PIPELINE_DEPTH) return -1;
+    struct pipeline *p = calloc(1, sizeof(struct pipeline));
+    if (!p) return -1;
+    p->queue = calloc((size_t)depth + 1, sizeof(struct in_flight));
+    p->pending = calloc((size_t)pred->table_size, sizeof(uint16_t));
+    if (!p->queue || !p->pending) {
+        free(p->queue);
+        free(p->pending);
+        free(p);
+        return -1;
+    }
+    p->depth = depth;
+    pred->state = p;
+    select_kernel(pred);
+    return 0;
+}
+
+static void table_print_stats(branch_predictor_t *pred) {
+    if (pred->type == PRED_BIMODAL || pred->type == PRED_GSHARE) {
+        printf("Config: entries=%d", pred->config.entries);
+        if (pred->type == PRED_GSHARE) {
+            printf(", hist=%d", pred->history_bits);
         }
-            
-        case PRED_GSHARE_256:
-        case PRED_GSHARE_1K:
-        case PRED_GSHARE_4K:
-        case PRED_GSHARE_16K: {
-            int index_bits = pred->history_bits;
-            uint32_t pc_bits = (pc >> 2) & ((1 << index_bits) - 1);
-            uint32_t hist_bits = pred->global_history & ((1 << index_bits) - 1);
-            int index = (pc_bits ^ hist_bits) % pred->table_size;
-            uint8_t *counter = &pred->table[index];
-            
-            if (taken) {
-                if (*counter < 3) {
-                    (*counter)++;
-                }
-            } else {
-                if (*counter > 0) {
-                    (*counter)--;
-                }
-            }
-            
-            pred->global_history = ((pred->global_history << 1) | (taken ? 1 : 0)) & ((1 << index_bits) - 1);
-            break;
+        if (pred->type == PRED_GSHARE || pred->config.hash != PREDICTOR_HASH_XOR) {
+            printf(", hash=%s", hash_names[pred->config.hash]);
         }
-            
-        default:
-            break;
+        printf(", ctr=%d, index=pc", pred->config.counter_bits);
+        if (pred->config.pc_shift) {
+            printf(">>%d", pred->config.pc_shift);
+        }
+        printf("\n");
+    }
+    int slots_per_word = 64 >> pred->slot_shift;
+    long words = (pred->table_size + slots_per_word - 1) / slots_per_word;
+    printf("Storage: %ld bits modeled (%d x %d-bit counters), %ld bytes on the host\n",
+           (long)pred->table_size * pred->config.counter_bits, pred->table_size,
+           pred->config.counter_bits, words * (long)sizeof(uint64_t));
+    struct pipeline *p = pred->state;
+    if (p) {
+        printf("Pipeline: %d branches in flight, counters updated at commit\n", p->depth);
+        printf("Predictions from counters with updates in flight: %lu\n", p->stale_reads);
+    }
+    if (pred->aliasing) {
+        // the counter states as of now, for the aliasing report
+        for (int i = 0; i < pred->table_size; i++) {
+            aliasing_set_counter(pred->aliasing, 0, (uint32_t)i, counter_get(pred, (uint32_t)i));
+        }
+    }
+}
+
+static void table_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    int slots_per_word = 64 >> pred->slot_shift;
+    size_t words = ((size_t)pred->table_size + slots_per_word - 1) / slots_per_word;
+    visit(arg, &pred->config, sizeof(pred->config), 1);
+    visit(arg, pred->table, words * sizeof(uint64_t), 0);
+    visit(arg, &pred->global_history, sizeof(pred->global_history), 0);
+}
+
+static int table_enable_aliasing(branch_predictor_t *pred) {
+    return aliasing_add_table(pred->aliasing, "counters", (uint32_t)pred->table_size,
+                              pred->config.counter_bits) < 0 ? -1 : 0;
+}
+
+static void table_destroy(branch_predictor_t *pred) {
+    struct pipeline *p = pred->state;
+    free(pred->table);
+    if (p) {
+        free(p->queue);
+        free(p->pending);
+        free(p);
+    }
+}
+
+static void *tage_family_create(branch_predictor_t *pred, const void *params) {
+    // the fixed sizes, or the budget given to predictor_create_tage()
+    return tage_create(params ? *(const int *)params : get_tage_budget_kb(pred->type));
+}
+
+static int tage_family_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return tage_predict(pred->state, pc);
+}
+
+static void tage_family_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    (void)target;
+    // predicts and trains in one pass
+    count_outcome(pred, tage_update(pred->state, pc, taken), taken);
+}
+
+static void tage_family_print_stats(branch_predictor_t *pred) {
+    tage_print_stats(pred->state);
+}
+
+static void tage_family_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    tage_state(pred->state, visit, arg);
+}
+
+static void tage_family_destroy(branch_predictor_t *pred) {
+    tage_delete(pred->state);
+}
+
+static void *perceptron_family_create(branch_predictor_t *pred, const void *params) {
+    (void)params;
+    return perceptron_create(get_perceptron_size(pred->type));
+}
+
+static int perceptron_family_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return perceptron_predict(pred->state, pc);
+}
+
+static void perceptron_family_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    (void)target;
+    count_outcome(pred, perceptron_update(pred->state, pc, taken), taken);
+}
+
+static void perceptron_family_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    struct perceptron *p = pred->state;
+    visit(arg, &p->count, sizeof(p->count), 1);
+    visit(arg, p->weights, (size_t)p->count * p->stride, 0);
+    visit(arg, p->inputs, sizeof(p->inputs), 0);
+}
+
+static void perceptron_family_destroy(branch_predictor_t *pred) {
+    perceptron_delete(pred->state);
+}
+
+struct tournament_params {
+    int bimodal_entries;
+    int gshare_entries;
+};
+
+static void *tournament_family_create(branch_predictor_t *pred, const void *params) {
+    const struct tournament_params *p = params;
+    (void)pred;
+    return p ? tournament_create(p->bimodal_entries, p->gshare_entries) : NULL;
+}
+
+static int tournament_family_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return tournament_predict(pred->state, pc);
+}
+
+static void tournament_family_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    (void)target;
+    count_outcome(pred, tournament_update(pred->state, pc, taken), taken);
+}
+
+static void tournament_family_print_stats(branch_predictor_t *pred) {
+    tournament_print_stats(pred->state);
+}
+
+static void tournament_family_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    struct tournament *t = pred->state;
+    visit(arg, &t->bimodal_size, sizeof(t->bimodal_size), 1);
+    visit(arg, &t->gshare_size, sizeof(t->gshare_size), 1);
+    visit(arg, t->bimodal, (size_t)t->bimodal_size, 0);
+    visit(arg, t->gshare, (size_t)t->gshare_size, 0);
+    visit(arg, t->chooser, (size_t)t->bimodal_size, 0);
+    visit(arg, &t->global_history, sizeof(t->global_history), 0);
+}
+
+static void tournament_family_destroy(branch_predictor_t *pred) {
+    tournament_delete(pred->state);
+}
+
+struct local_params {
+    int history_entries;
+    int pattern_entries;
+};
+
+static void *local_family_create(branch_predictor_t *pred, const void *params) {
+    const struct local_params *p = params;
+    return p ? local_create(pred->type, p->history_entries, p->pattern_entries) : NULL;
+}
+
+static int local_family_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return local_predict(pred->state, pc);
+}
+
+static void local_family_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    (void)target;
+    count_outcome(pred, local_update(pred->state, pc, taken), taken);
+}
+
+static void local_family_print_stats(branch_predictor_t *pred) {
+    local_print_stats(pred->state);
+}
+
+static void local_family_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    struct local_predictor *l = pred->state;
+    size_t counters = (size_t)l->pattern_entries * (l->type == PRED_PAP ? l->history_entries : 1);
+    visit(arg, &l->history_entries, sizeof(l->history_entries), 1);
+    visit(arg, &l->pattern_entries, sizeof(l->pattern_entries), 1);
+    visit(arg, l->histories, (size_t)l->history_entries * sizeof(uint16_t), 0);
+    visit(arg, l->patterns, counters, 0);
+}
+
+static void local_family_destroy(branch_predictor_t *pred) {
+    local_delete(pred->state);
+}
+
+static void *dealiased_family_create(branch_predictor_t *pred, const void *params) {
+    dealias_kind_t kind;
+    int size = get_dealiased_size(pred->type, &kind);
+    (void)params;
+    return dealiased_create(kind, size);
+}
+
+static int dealiased_family_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    return dealiased_predict(pred->state, pc);
+}
+
+static void dealiased_family_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    (void)target;
+    count_outcome(pred, dealiased_update(pred->state, pred->aliasing, pc, taken), taken);
+}
+
+static void dealiased_family_print_stats(branch_predictor_t *pred) {
+    if (pred->aliasing) {
+        // the counter states as of now, for the aliasing report
+        dealiased_report_counters(pred->state, pred->aliasing);
     }
 }
 
+static int dealiased_family_enable_aliasing(branch_predictor_t *pred) {
+    return dealiased_enable_aliasing(pred->state, pred->aliasing);
+}
+
+static void dealiased_family_state(branch_predictor_t *pred, predictor_state_fn visit, void *arg) {
+    struct dealiased *d = pred->state;
+    visit(arg, &d->size, sizeof(d->size), 1);
+    visit(arg, d->choice, (size_t)d->choice_entries, 0);
+    for (int i = 0; i < 2; i++) {
+        if (d->direction[i]) visit(arg, d->direction[i], (size_t)d->direction_entries, 0);
+        if (d->tags[i]) visit(arg, d->tags[i], (size_t)d->direction_entries, 0);
+    }
+    visit(arg, &d->global_history, sizeof(d->global_history), 0);
+}
+
+static void dealiased_family_destroy(branch_predictor_t *pred) {
+    dealiased_delete(pred->state);
+}
+
+// Reference predictors driven by an outcome profile from an earlier run: the
+// profile-guided static predictor takes each branch's majority direction, the
+// oracle the majority direction per branch and global history. Branches the
+// profile has not seen (in that history) are predicted not taken.
+struct bound {
+    struct outcome_profile *profile;
+    uint64_t history;
+    uint64_t history_mask;
+    uint64_t unseen;
+};
+
+struct bound_params {
+    struct outcome_profile *profile;    // owned by the predictor once created
+    int history_bits;
+};
+
+static void *bound_create(branch_predictor_t *pred, const void *params) {
+    const struct bound_params *p = params;
+    (void)pred;
+    struct bound *b = p ? calloc(1, sizeof(struct bound)) : NULL;
+    if (!b) return NULL;
+    b->profile = p->profile;
+    b->history_mask = p->history_bits == 64 ? ~0ull : (1ull << p->history_bits) - 1;
+    return b;
+}
+
+static int bound_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    (void)target;
+    struct bound *b = pred->state;
+    return outcome_profile_majority(b->profile, pc, b->history) == 1;
+}
+
+static void bound_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    struct bound *b = pred->state;
+    int majority = outcome_profile_majority(b->profile, pc, b->history);
+    (void)target;
+    b->unseen += majority < 0;
+    count_outcome(pred, majority == 1, taken);
+    b->history = ((b->history << 1) | (taken != 0)) & b->history_mask;
+}
+
+static void bound_print_stats(branch_predictor_t *pred) {
+    struct bound *b = pred->state;
+    printf("Profile: %u branches, %u contexts, %d history bits\n",
+           outcome_profile_branches(b->profile), outcome_profile_contexts(b->profile),
+           outcome_profile_history_bits(b->profile));
+    printf("Predictions without a profile entry: %lu\n", b->unseen);
+}
+
+static void bound_destroy(branch_predictor_t *pred) {
+    struct bound *b = pred->state;
+    outcome_profile_delete(b->profile);
+    free(b);
+}
+
+static const predictor_ops_t static_ops = {
+    NULL, static_predict, static_update, NULL, NULL, NULL, NULL, NULL
+};
+static const predictor_ops_t table_ops = {
+    NULL, table_predict, table_update, NULL, table_print_stats, table_destroy, table_state,
+    table_enable_aliasing
+};
+static const predictor_ops_t tage_ops = {
+    tage_family_create, tage_family_predict, tage_family_update, NULL, tage_family_print_stats,
+    tage_family_destroy, tage_family_state, NULL
+};
+static const predictor_ops_t perceptron_ops = {
+    perceptron_family_create, perceptron_family_predict, perceptron_family_update, NULL, NULL,
+    perceptron_family_destroy, perceptron_family_state, NULL
+};
+static const predictor_ops_t tournament_ops = {
+    tournament_family_create, tournament_family_predict, tournament_family_update, NULL,
+    tournament_family_print_stats, tournament_family_destroy, tournament_family_state, NULL
+};
+static const predictor_ops_t local_ops = {
+    local_family_create, local_family_predict, local_family_update, NULL, local_family_print_stats,
+    local_family_destroy, local_family_state, NULL
+};
+static const predictor_ops_t dealiased_ops = {
+    dealiased_family_create, dealiased_family_predict, dealiased_family_update, NULL,
+    dealiased_family_print_stats, dealiased_family_destroy, dealiased_family_state,
+    dealiased_family_enable_aliasing
+};
+static const predictor_ops_t bound_ops = {
+    bound_create, bound_predict, bound_update, NULL, bound_print_stats, bound_destroy, NULL, NULL
+};
+
+static const predictor_ops_t *family_ops(predictor_type_t type) {
+    if (get_table_size(type) > 0 || type == PRED_BIMODAL || type == PRED_GSHARE) return &table_ops;
+    if (get_tage_budget_kb(type) > 0 || type == PRED_TAGE_SC_L) return &tage_ops;
+    if (get_perceptron_size(type) > 0) return &perceptron_ops;
+    if (type == PRED_TOURNAMENT) return &tournament_ops;
+    if (type == PRED_PAG || type == PRED_PAP || type == PRED_SAG) return &local_ops;
+    dealias_kind_t kind;
+    if (get_dealiased_size(type, &kind) > 0) return &dealiased_ops;
+    if (type == PRED_PROFILE_STATIC || type == PRED_ORACLE) return &bound_ops;
+    // families defined elsewhere (plugins) pass their own operations to
+    // predictor_create_family()
+    return &static_ops;
+}
+
+branch_predictor_t* predictor_create_tage(int budget_kb) {
+    return predictor_create_family(PRED_TAGE_SC_L, &tage_ops, &budget_kb);
+}
+
+branch_predictor_t* predictor_create_tournament(int bimodal_entries, int gshare_entries) {
+    if (!is_power_of_two(bimodal_entries) || !is_power_of_two(gshare_entries)) {
+        return NULL;
+    }
+    struct tournament_params params = { bimodal_entries, gshare_entries };
+    return predictor_create_family(PRED_TOURNAMENT, &tournament_ops, &params);
+}
+
+branch_predictor_t* predictor_create_local(predictor_type_t type, int history_entries, int pattern_entries) {
+    if (type != PRED_PAG && type != PRED_PAP && type != PRED_SAG) {
+        return NULL;
+    }
+    // histories are kept in 16 bits
+    if (!is_power_of_two(history_entries) || !is_power_of_two(pattern_entries)
+        || pattern_entries > 65536) {
+        return NULL;
+    }
+    struct local_params params = { history_entries, pattern_entries };
+    return predictor_create_family(type, &local_ops, &params);
+}
+
+branch_predictor_t* predictor_create_bound(predictor_type_t type, const char *file_name, int history_bits) {
+    if (type != PRED_PROFILE_STATIC && type != PRED_ORACLE) return NULL;
+    struct outcome_profile *recorded = outcome_profile_read(file_name);
+    if (!recorded) return NULL;
+    if (type == PRED_PROFILE_STATIC) {
+        history_bits = 0;
+    } else if (history_bits < 0) {
+        history_bits = outcome_profile_history_bits(recorded);
+    }
+    struct outcome_profile *profile = outcome_profile_reduce(recorded, history_bits);
+    outcome_profile_delete(recorded);
+    if (!profile) return NULL;
+    struct bound_params params = { profile, history_bits };
+    branch_predictor_t *pred = predictor_create_family(type, &bound_ops, &params);
+    if (!pred) {
+        outcome_profile_delete(profile);
+    }
+    return pred;
+}
+
+// Specialized kernels for the fixed bimodal and gShare sizes: 2-bit counters
+// (32 to a word), constant masks and one index computation per branch. The
+// saturating step is computed without branches and merged back with one XOR.
+static inline void counter_kernel(branch_predictor_t *pred, uint32_t index, int taken) {
+    uint64_t *word = &pred->table[index >> 5];
+    int offset = (int)(index & 31) * 2;
+    unsigned c = (unsigned)(*word >> offset) & 3;
+    pred->stats.total_branches++;
+    pred->stats.mispredictions += (uint64_t)((c >> 1) != (taken != 0));
+    unsigned next = taken ? c + (c < 3) : c - (c > 0);
+    *word ^= (uint64_t)(c ^ next) << offset;
+}
+
+#define BIMODAL_KERNEL(entries)                                                     \
+static void update_bimodal_##entries(branch_predictor_t *pred, uint32_t pc,        \
+                                     uint32_t target, int taken) {                 \
+    (void)target;                                                                   \
+    counter_kernel(pred, pc & ((entries) - 1), taken);                               \
+}
+
+#define GSHARE_KERNEL(entries)                                                      \
+static void update_gshare_##entries(branch_predictor_t *pred, uint32_t pc,         \
+                                    uint32_t target, int taken) {                  \
+    (void)target;                                                                   \
+    uint32_t history = (uint32_t)pred->global_history;                              \
+    counter_kernel(pred, ((pc >> 2) ^ history) & ((entries) - 1), taken);          \
+    pred->global_history = ((history << 1) | (taken != 0)) & ((entries) - 1);       \
+}
+
+BIMODAL_KERNEL(256)
+BIMODAL_KERNEL(1024)
+BIMODAL_KERNEL(4096)
+BIMODAL_KERNEL(16384)
+GSHARE_KERNEL(256)
+GSHARE_KERNEL(1024)
+GSHARE_KERNEL(4096)
+GSHARE_KERNEL(16384)
+
+static const struct {
+    predictor_type_t type;
+    int entries;
+    predictor_update_fn update;
+} kernels[] = {
+    { PRED_BIMODAL, 256, update_bimodal_256 },   { PRED_BIMODAL, 1024, update_bimodal_1024 },
+    { PRED_BIMODAL, 4096, update_bimodal_4096 }, { PRED_BIMODAL, 16384, update_bimodal_16384 },
+    { PRED_GSHARE, 256, update_gshare_256 },     { PRED_GSHARE, 1024, update_gshare_1024 },
+    { PRED_GSHARE, 4096, update_gshare_4096 },   { PRED_GSHARE, 16384, update_gshare_16384 },
+};
+
+// The kernel for the predictor's configuration; anything without a specialized
+// kernel, or with aliasing statistics enabled, uses the family's update.
+static predictor_update_fn specialized_kernel(const branch_predictor_t *pred) {
+    const predictor_config_t *c = &pred->config;
+    if (pred->table && pred->state) return table_update_pipelined;
+    if (!pred->table || pred->aliasing || c->counter_bits != 2
+        || (c->hash != PREDICTOR_HASH_XOR && c->hash != PREDICTOR_HASH_FOLD)) return pred->ops->update;
+    // the layouts of the fixed-size predictors
+    if (c->type == PRED_BIMODAL ? c->pc_shift != 0
+        : (c->pc_shift != 2 || c->history_bits != pred->index_bits)) return pred->ops->update;
+    for (unsigned i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (kernels[i].type == c->type && kernels[i].entries == c->entries) {
+            return kernels[i].update;
+        }
+    }
+    return pred->ops->update;
+}
+
+// Runs the predictor's kernel, then attributes the outcome to the branch and/or
+// records it in the outcome profile and the predictability analysis. Deferred
+// (batched) updates are flushed every time so each misprediction is seen here.
+static void observed_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    uint64_t mispredictions = pred->stats.mispredictions;
+    pred->observed_update(pred, pc, target, taken);
+    if (pred->profile) {
+        if (pred->ops->flush) {
+            pred->ops->flush(pred);
+        }
+        branch_profile_record(pred->profile, pc, taken, pred->stats.mispredictions != mispredictions);
+    }
+    if (pred->recording) {
+        outcome_profile_record(pred->recording, pc, taken);
+    }
+    if (pred->analysis) {
+        branch_analysis_record(pred->analysis, pc, taken);
+    }
+}
+
+static void select_kernel(branch_predictor_t *pred) {
+    pred->update = specialized_kernel(pred);
+    if (pred->profile || pred->recording || pred->analysis) {
+        pred->observed_update = pred->update;
+        pred->update = observed_update;
+    }
+}
+
+int predictor_enable_recording(branch_predictor_t *pred, int history_bits) {
+    pred->recording = outcome_profile_create(history_bits);
+    if (!pred->recording) return -1;
+    select_kernel(pred);
+    return 0;
+}
+
+int predictor_enable_analysis(branch_predictor_t *pred) {
+    pred->analysis = branch_analysis_create();
+    if (!pred->analysis) return -1;
+    select_kernel(pred);
+    return 0;
+}
+
+int predictor_enable_profile(branch_predictor_t *pred) {
+    pred->profile = branch_profile_create();
+    if (!pred->profile) return -1;
+    select_kernel(pred);
+    return 0;
+}
+
+void predictor_flush(branch_predictor_t *pred) {
+    if (pred->ops->flush) {
+        pred->ops->flush(pred);
+    }
+}
+
+// Saved state: a header with the predictor type, then every block visited by
+// the family's state() as its size in bytes and the bytes, in host byte order.
+#define STATE_MAGIC "RVBPSTAT"
+#define STATE_VERSION 1
+
+struct state_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t type;
+};
+
+struct state_file {
+    FILE *file;
+    int loading;
+    int error;
+};
+
+static void state_block(void *arg, void *data, size_t bytes, int shape) {
+    struct state_file *s = arg;
+    uint64_t size = bytes;
+    if (s->error) return;
+    if (!s->loading) {
+        s->error = fwrite(&size, sizeof(size), 1, s->file) != 1
+                || fwrite(data, 1, bytes, s->file) != bytes;
+        return;
+    }
+    if (fread(&size, sizeof(size), 1, s->file) != 1 || size != bytes) {
+        s->error = 1;
+    } else if (shape) {
+        unsigned char *saved = malloc(bytes);
+        s->error = !saved || fread(saved, 1, bytes, s->file) != bytes || memcmp(saved, data, bytes);
+        free(saved);
+    } else {
+        s->error = fread(data, 1, bytes, s->file) != bytes;
+    }
+}
+
+int predictor_save(branch_predictor_t *pred, const char *file_name) {
+    if (!pred->ops->state) return -1;
+    predictor_flush(pred);
+    struct state_header header = { STATE_MAGIC, STATE_VERSION, (uint32_t)pred->type };
+    struct state_file s = { fopen(file_name, "wb"), 0, 0 };
+    if (!s.file) return -1;
+    s.error = fwrite(&header, sizeof(header), 1, s.file) != 1;
+    pred->ops->state(pred, state_block, &s);
+    if (fclose(s.file)) s.error = 1;
+    return s.error ? -1 : 0;
+}
+
+int predictor_load(branch_predictor_t *pred, const char *file_name) {
+    if (!pred->ops->state) return -1;
+    struct state_header header;
+    struct state_file s = { fopen(file_name, "rb"), 1, 0 };
+    if (!s.file) return -1;
+    s.error = fread(&header, sizeof(header), 1, s.file) != 1
+           || memcmp(header.magic, STATE_MAGIC, sizeof(header.magic))
+           || header.version != STATE_VERSION || header.type != (uint32_t)pred->type;
+    pred->ops->state(pred, state_block, &s);
+    // nothing may follow the last block
+    if (!s.error && fgetc(s.file) != EOF) s.error = 1;
+    fclose(s.file);
+    return s.error ? -1 : 0;
+}
+
 void predictor_print_stats(branch_predictor_t *pred) {
     if (!pred) return;
+    predictor_flush(pred);
     
     printf("\n=== Branch Predictor Statistics ===\n");
     printf("Predictor: %s\n", predictor_name(pred->type));
@@ -185,6 +1680,12 @@ void predictor_print_stats(branch_predictor_t *pred) {
     } else {
         printf("Misprediction rate: N/A (no branches)\n");
     }
+    if (pred->ops->print_stats) {
+        pred->ops->print_stats(pred);
+    }
+    if (pred->aliasing) {
+        aliasing_print(pred->aliasing);
+    }
     printf("===================================\n\n");
 }
 
@@ -201,6 +1702,35 @@ const char* predictor_name(predictor_type_t type) {
         case PRED_GSHARE_1K:    return "gShare (1024 entries)";
         case PRED_GSHARE_4K:    return "gShare (4096 entries)";
         case PRED_GSHARE_16K:   return "gShare (16384 entries)";
+        case PRED_TAGE_SC_L_8K: return "TAGE-SC-L (8KB budget)";
+        case PRED_TAGE_SC_L_32K: return "TAGE-SC-L (32KB budget)";
+        case PRED_TAGE_SC_L_64K: return "TAGE-SC-L (64KB budget)";
+        case PRED_PERCEPTRON_256: return "Perceptron (8 x 8 weights, 512 bits)";
+        case PRED_PERCEPTRON_1K:  return "Perceptron (16 x 16 weights, 2048 bits)";
+        case PRED_PERCEPTRON_4K:  return "Perceptron (32 x 32 weights, 8192 bits)";
+        case PRED_PERCEPTRON_16K: return "Perceptron (64 x 64 weights, 32768 bits)";
+        case PRED_TOURNAMENT:   return "Tournament (bimodal + gShare, 2-bit chooser)";
+        case PRED_PAG:          return "PAg (per-address histories, global pattern table)";
+        case PRED_PAP:          return "PAp (per-address histories, per-address pattern tables)";
+        case PRED_SAG:          return "SAg (per-set histories, global pattern table)";
+        case PRED_BIMODE_256:   return "Bi-mode (256 counters)";
+        case PRED_BIMODE_1K:    return "Bi-mode (1024 counters)";
+        case PRED_BIMODE_4K:    return "Bi-mode (4096 counters)";
+        case PRED_BIMODE_16K:   return "Bi-mode (16384 counters)";
+        case PRED_AGREE_256:    return "Agree (256 counters)";
+        case PRED_AGREE_1K:     return "Agree (1024 counters)";
+        case PRED_AGREE_4K:     return "Agree (4096 counters)";
+        case PRED_AGREE_16K:    return "Agree (16384 counters)";
+        case PRED_YAGS_256:     return "YAGS (256 counters)";
+        case PRED_YAGS_1K:      return "YAGS (1024 counters)";
+        case PRED_YAGS_4K:      return "YAGS (4096 counters)";
+        case PRED_YAGS_16K:     return "YAGS (16384 counters)";
+        case PRED_BIMODAL:      return "Bimodal";
+        case PRED_GSHARE:       return "gShare";
+        case PRED_TAGE_SC_L:    return "TAGE-SC-L";
+        case PRED_PLUGIN:       return "Plugin";
+        case PRED_PROFILE_STATIC: return "Profile-guided static (majority direction per branch)";
+        case PRED_ORACLE:       return "Oracle (majority direction per branch and history)";
         default:                return "Unknown";
     }
 }
@@ -15,31 +15,210 @@ typedef enum {
     PRED_GSHARE_256,
     PRED_GSHARE_1K,
     PRED_GSHARE_4K,
-    PRED_GSHARE_16K
+    PRED_GSHARE_16K,
+    PRED_TAGE_SC_L_8K,
+    PRED_TAGE_SC_L_32K,
+    PRED_TAGE_SC_L_64K,
+    PRED_PERCEPTRON_256,
+    PRED_PERCEPTRON_1K,
+    PRED_PERCEPTRON_4K,
+    PRED_PERCEPTRON_16K,
+    PRED_TOURNAMENT,
+    PRED_PAG,
+    PRED_PAP,
+    PRED_SAG,
+    PRED_BIMODE_256,
+    PRED_BIMODE_1K,
+    PRED_BIMODE_4K,
+    PRED_BIMODE_16K,
+    PRED_AGREE_256,
+    PRED_AGREE_1K,
+    PRED_AGREE_4K,
+    PRED_AGREE_16K,
+    PRED_YAGS_256,
+    PRED_YAGS_1K,
+    PRED_YAGS_4K,
+    PRED_YAGS_16K,
+    PRED_BIMODAL,       // sized by a predictor_config_t
+    PRED_GSHARE,
+    PRED_TAGE_SC_L,     // storage budget given to predictor_create_tage()
+    PRED_PLUGIN,        // loaded from a shared object, see predictor_plugin.h
+    PRED_PROFILE_STATIC,    // bounds from an outcome profile, see predictor_create_bound()
+    PRED_ORACLE
 } predictor_type_t;
 
+// How a counter-table predictor forms its index from pc >> pc_shift and the
+// global history (none for bimodal).
+typedef enum {
+    PREDICTOR_HASH_XOR,     // pc ^ history, bits beyond the index width are dropped
+    PREDICTOR_HASH_FOLD,    // pc ^ history folded into the index width by XOR
+    PREDICTOR_HASH_PCFOLD,  // as fold, with the pc folded as well
+    PREDICTOR_HASH_MULT,    // multiplicative (Fibonacci) hash of pc ^ history
+    PREDICTOR_HASH_GSELECT  // low pc bits concatenated with the history bits
+} predictor_hash_t;
+
+// Parameters of a counter-table predictor (bimodal or gShare).
+typedef struct {
+    predictor_type_t type;      // PRED_BIMODAL or PRED_GSHARE
+    int entries;                // power of two
+    int history_bits;           // gShare: global history length, up to 64
+    int counter_bits;           // 1..8
+    int pc_shift;               // the index is taken from pc >> pc_shift
+    predictor_hash_t hash;
+} predictor_config_t;
+
 typedef struct {
     predictor_type_t type;
     uint64_t total_branches;
     uint64_t mispredictions;
 } predictor_stats_t;
 
-typedef struct {
+struct aliasing;
+struct branch_profile;
+struct outcome_profile;
+struct branch_analysis;
+struct branch_predictor;
+
+// predicts a branch, counts the outcome in the stats and trains the predictor
+typedef void (*predictor_update_fn)(struct branch_predictor *pred, uint32_t pc, uint32_t target, int taken);
+
+// Visits one block of a predictor's state. Blocks with 'shape' set describe the
+// predictor's geometry rather than what it has learned; they must match when
+// saved state is loaded.
+typedef void (*predictor_state_fn)(void *arg, void *data, size_t bytes, int shape);
+
+// Operations of a predictor family. create() returns the family's own state,
+// kept in pred->state, from family specific 'params' (NULL for the defaults of
+// pred->type), or NULL on failure; destroy() frees it. Both may be NULL for
+// families without state. predict() has no side effects; update() predicts the
+// branch, counts the outcome in the stats and trains. flush() applies updates
+// the family has deferred and print_stats() prints its own statistics; both may
+// be NULL. state() passes every block of learned state to 'visit', always in
+// the same order; NULL if the state cannot be saved. enable_aliasing() adds the
+// family's tables to pred->aliasing and reports their counters to it when the
+// statistics are printed; NULL if not supported.
+typedef struct predictor_ops {
+    void *(*create)(struct branch_predictor *pred, const void *params);
+    int (*predict)(struct branch_predictor *pred, uint32_t pc, uint32_t target);
+    predictor_update_fn update;
+    void (*flush)(struct branch_predictor *pred);
+    void (*print_stats)(struct branch_predictor *pred);
+    void (*destroy)(struct branch_predictor *pred);
+    void (*state)(struct branch_predictor *pred, predictor_state_fn visit, void *arg);
+    int (*enable_aliasing)(struct branch_predictor *pred);
+} predictor_ops_t;
+
+typedef struct branch_predictor {
     predictor_type_t type;
     predictor_stats_t stats;
+    const predictor_ops_t *ops;
+    // predict-and-update kernel chosen at creation: ops->update, or a version
+    // specialized for one of the fixed sizes
+    predictor_update_fn update;
     
 
-    uint8_t *table;
+    // counters packed into 64-bit words, each in a slot of 1 << slot_shift bits
+    // (the counter width rounded up to a power of two)
+    uint64_t *table;
     int table_size;
+    int slot_shift;
     
-    uint32_t global_history;
+    uint64_t global_history;
     int history_bits;
+    predictor_config_t config;  // for the counter-table predictors
+    int index_bits;
+    // index function for config.hash, and its last result: computed once per
+    // branch and reused by the update after a predict
+    uint32_t (*index_fn)(const struct branch_predictor *pred, uint32_t pc);
+    uint32_t index_pc;
+    uint64_t index_history;
+    uint32_t index;
+
+    void *state;                // the family's own, see predictor_ops_t
+    struct aliasing *aliasing;
+    struct branch_profile *profile;     // per-branch outcomes, see predictor_enable_profile()
+    struct outcome_profile *recording;  // see predictor_enable_recording()
+    struct branch_analysis *analysis;   // see predictor_enable_analysis()
+    predictor_update_fn observed_update;    // the kernel wrapped while profiling, recording or analysing
 } branch_predictor_t;
 
 branch_predictor_t* predictor_create(predictor_type_t type);
+// A predictor of the family implemented by 'ops', with its state created by
+// ops->create(pred, params); for families outside this file (see
+// predictor_plugin.c). Returns NULL if the state cannot be created.
+branch_predictor_t* predictor_create_family(predictor_type_t type, const predictor_ops_t *ops,
+                                            const void *params);
+// the fixed types by their command line names ("NT", "gshare-4K", ...); PRED_NONE
+// for anything else
+predictor_type_t predictor_parse_type(const char *str);
+// Parses a specification such as "gshare:entries=64K,hist=12,ctr=3,hash=fold" or
+// "bimodal:entries=1M,index=pc>>2" into 'config'. Keys: entries (K/M suffixes),
+// hist, ctr, index (pc or pc>>N), hash (xor, fold, pcfold, mult or gselect, see
+// predictor_hash_t; gselect needs fewer history than index bits). Returns -1 on errors.
+int predictor_parse_spec(const char *spec, predictor_config_t *config);
+branch_predictor_t* predictor_create_config(const predictor_config_t *config);
+// TAGE-SC-L sized to a budget of 'budget_kb' KB (see tage_create())
+branch_predictor_t* predictor_create_tage(int budget_kb);
+// bimodal and gShare side by side with a PC-indexed chooser (Alpha 21264 style);
+// sizes are numbers of 2-bit counters and must be powers of two
+branch_predictor_t* predictor_create_tournament(int bimodal_entries, int gshare_entries);
+// two-level local-history predictors (Yeh & Patt): PRED_PAG, PRED_PAP or PRED_SAG
+// with 'history_entries' history registers, each selecting one of 'pattern_entries'
+// 2-bit counters (so histories are log2(pattern_entries) bits); both powers of two
+branch_predictor_t* predictor_create_local(predictor_type_t type, int history_entries, int pattern_entries);
+// Reference predictors from an outcome profile written by an earlier run
+// (predictor_enable_recording()): PRED_PROFILE_STATIC predicts each branch's
+// majority direction, PRED_ORACLE the majority direction for each branch and
+// 'history_bits' of global history (-1 for all the profile has). Returns NULL
+// if the file cannot be read or has fewer history bits.
+branch_predictor_t* predictor_create_bound(predictor_type_t type, const char *file_name, int history_bits);
+// Loads a predictor from the shared object at 'path' and creates it with 'args'
+// (may be NULL). Prints the reason and returns NULL on failure.
+branch_predictor_t* predictor_create_plugin(const char *path, const char *args);
+// Any predictor by its sim -p name: a fixed type, a specification, tage-sc-l-NK,
+// tournament-B-G, pag-/pap-/sag-H-P, profile:FILE, oracle:FILE[:H] or
+// plugin:PATH.so[:ARGS]. Prints the reason and returns NULL on failure.
+branch_predictor_t* predictor_create_named(const char *name);
 void predictor_destroy(branch_predictor_t *pred);
+// track constructive/destructive aliasing in the predictor's tables (bimodal, gShare,
+// bi-mode, agree and YAGS); returns -1 if not supported by the predictor
+int predictor_enable_aliasing(branch_predictor_t *pred);
+// Models 'depth' conditional branches in flight for bimodal and gShare: counter
+// updates are delayed until a branch commits. Only correct-path branches are
+// simulated, so the global history holds the actual outcomes, as it does after
+// a misprediction has been repaired. Depth 0 is the idealized immediate update.
+// Returns -1 for other predictors.
+#define PREDICTOR_MAX_PIPELINE_DEPTH 1024
+int predictor_enable_pipeline(branch_predictor_t *pred, int depth);
+// record taken/not-taken counts per branch and 'history_bits' (0..64) of global
+// history in pred->recording, to be saved with outcome_profile_write()
+int predictor_enable_recording(branch_predictor_t *pred, int history_bits);
+// count executions, taken outcomes and mispredictions per branch address in
+// pred->profile (reported with branch_profile_print()); returns -1 on failure
+int predictor_enable_profile(branch_predictor_t *pred);
+// classify every branch by predictability and measure its conditional entropy
+// in pred->analysis (reported with branch_analysis_print()); returns -1 on failure
+int predictor_enable_analysis(branch_predictor_t *pred);
+// Save the learned state (counter tables, histories and auxiliary structures,
+// but not the statistics) to a file, and load it into a predictor created with
+// the same configuration for warm-start runs. Branches still in flight (see
+// predictor_enable_pipeline()) are not part of the state. Both return -1 on
+// failure or for predictors without state (static, plugins, profile bounds);
+// a failed load leaves the predictor's state undefined.
+int predictor_save(branch_predictor_t *pred, const char *file_name);
+int predictor_load(branch_predictor_t *pred, const char *file_name);
 int predictor_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target);
-void predictor_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken);
+// applies deferred updates so the stats cover every branch seen so far
+void predictor_flush(branch_predictor_t *pred);
+
+// Predicts the branch, counts a misprediction and trains the predictor. The
+// host cost of an update is measured by bench/predictor_bench.
+static inline void predictor_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    if (!pred || pred->type == PRED_NONE) {
+        return;
+    }
+    pred->update(pred, pc, target, taken);
+}
 void predictor_print_stats(branch_predictor_t *pred);
 const char* predictor_name(predictor_type_t type);
 
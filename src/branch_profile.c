@@ -0,0 +1,125 @@
+#include "branch_profile.h"
+#include "disassemble.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct branch_counts {
+    uint32_t pc;                // 0 marks an empty slot
+    uint64_t executions;
+    uint64_t taken;
+    uint64_t mispredictions;
+};
+
+// open-addressed hash table, kept at most half full
+struct branch_profile {
+    struct branch_counts *slots;
+    uint32_t mask;
+    uint32_t count;
+    uint64_t total_mispredictions;
+};
+
+struct branch_profile *branch_profile_create(void) {
+    struct branch_profile *bp = calloc(1, sizeof(struct branch_profile));
+    if (!bp) return NULL;
+    bp->mask = (1u << 10) - 1;
+    bp->slots = calloc(bp->mask + 1, sizeof(struct branch_counts));
+    if (!bp->slots) {
+        free(bp);
+        return NULL;
+    }
+    return bp;
+}
+
+void branch_profile_delete(struct branch_profile *bp) {
+    if (bp) {
+        free(bp->slots);
+        free(bp);
+    }
+}
+
+static struct branch_counts *find_slot(struct branch_counts *slots, uint32_t mask, uint32_t pc) {
+    // branch addresses are word aligned; spread them with a multiplicative hash
+    uint32_t slot = ((pc >> 2) * 0x9e3779b1u) & mask;
+    while (slots[slot].pc != 0 && slots[slot].pc != pc) {
+        slot = (slot + 1) & mask;
+    }
+    return &slots[slot];
+}
+
+static void grow(struct branch_profile *bp) {
+    uint32_t mask = bp->mask * 2 + 1;
+    struct branch_counts *slots = calloc((size_t)mask + 1, sizeof(struct branch_counts));
+    if (!slots) {
+        fprintf(stderr, "Out of memory for branch profile\n");
+        exit(-1);
+    }
+    for (uint32_t i = 0; i <= bp->mask; i++) {
+        if (bp->slots[i].pc != 0) {
+            *find_slot(slots, mask, bp->slots[i].pc) = bp->slots[i];
+        }
+    }
+    free(bp->slots);
+    bp->slots = slots;
+    bp->mask = mask;
+}
+
+void branch_profile_record(struct branch_profile *bp, uint32_t pc, int taken, int mispredicted) {
+    struct branch_counts *b = find_slot(bp->slots, bp->mask, pc);
+    if (b->pc == 0) {
+        if (2 * (bp->count + 1) > bp->mask) {
+            grow(bp);
+            b = find_slot(bp->slots, bp->mask, pc);
+        }
+        b->pc = pc;
+        bp->count++;
+    }
+    b->executions++;
+    b->taken += taken != 0;
+    b->mispredictions += mispredicted != 0;
+    bp->total_mispredictions += mispredicted != 0;
+}
+
+static int by_mispredictions(const void *a, const void *b) {
+    const struct branch_counts *x = *(const struct branch_counts * const *)a;
+    const struct branch_counts *y = *(const struct branch_counts * const *)b;
+    if (x->mispredictions != y->mispredictions) {
+        return x->mispredictions < y->mispredictions ? 1 : -1;
+    }
+    return x->pc < y->pc ? -1 : x->pc > y->pc;
+}
+
+void branch_profile_print(const struct branch_profile *bp, int top,
+                          struct memory *mem, struct symbols *symbols) {
+    const struct branch_counts **sorted = malloc((bp->count + 1) * sizeof(*sorted));
+    if (!sorted) return;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i <= bp->mask; i++) {
+        if (bp->slots[i].pc != 0) sorted[n++] = &bp->slots[i];
+    }
+    qsort(sorted, n, sizeof(*sorted), by_mispredictions);
+    if ((uint32_t)top > n) top = (int)n;
+
+    printf("\n=== Top %d of %u branches by mispredictions ===\n", top, n);
+    printf("%-8s  %-24s %10s %7s %10s %7s %7s  %s\n", "pc", "function", "executed", "taken",
+           "mispred", "rate", "share", "instruction");
+    for (int i = 0; i < top; i++) {
+        const struct branch_counts *b = sorted[i];
+        char where[64];
+        char disassembly[100];
+        unsigned int offset;
+        const char *function = symbols ? symbols_containing_function(symbols, b->pc, &offset) : NULL;
+        if (function) {
+            snprintf(where, sizeof(where), "%s+0x%x", function, offset);
+        } else {
+            snprintf(where, sizeof(where), "?");
+        }
+        disassemble(b->pc, (uint32_t)memory_rd_w(mem, (int)b->pc), disassembly, sizeof(disassembly), symbols);
+        printf("%08x  %-24s %10lu %6.1f%% %10lu %6.2f%% %6.2f%%  %s\n", b->pc, where, b->executions,
+               100.0 * b->taken / b->executions, b->mispredictions,
+               100.0 * b->mispredictions / b->executions,
+               bp->total_mispredictions ? 100.0 * b->mispredictions / bp->total_mispredictions : 0.0,
+               disassembly);
+    }
+    printf("===============================================\n\n");
+    free(sorted);
+}
@@ -0,0 +1,22 @@
+#ifndef __BRANCH_PROFILE_H__
+#define __BRANCH_PROFILE_H__
+
+#include <stdint.h>
+#include "memory.h"
+#include "read_elf.h"
+
+// Per-static-branch outcome counters, keyed by branch address, for attributing
+// mispredictions to the branches that cause them.
+struct branch_profile;
+
+struct branch_profile *branch_profile_create(void);
+void branch_profile_delete(struct branch_profile *bp);
+
+void branch_profile_record(struct branch_profile *bp, uint32_t pc, int taken, int mispredicted);
+
+// Prints the 'top' branches with the most mispredictions, each with its
+// containing function and disassembly.
+void branch_profile_print(const struct branch_profile *bp, int top,
+                          struct memory *mem, struct symbols *symbols);
+
+#endif
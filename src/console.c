@@ -0,0 +1,109 @@
+#include "console.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CONSOLE_BUF_SIZE 65536
+
+static console_flush_mode_t flush_mode = CONSOLE_FLUSH_LINE;
+
+static char out_buf[CONSOLE_BUF_SIZE];
+static size_t out_len;
+
+static unsigned char in_buf[CONSOLE_BUF_SIZE];
+static size_t in_pos;
+static size_t in_len;
+static int in_eof;
+
+static int capturing;
+static char *capture_buf;
+static size_t capture_len;
+static size_t capture_cap;
+
+void console_set_flush_mode(console_flush_mode_t mode) {
+    flush_mode = mode;
+}
+
+int console_parse_flush_mode(const char *str, console_flush_mode_t *mode) {
+    if (strcmp(str, "line") == 0) *mode = CONSOLE_FLUSH_LINE;
+    else if (strcmp(str, "exit") == 0) *mode = CONSOLE_FLUSH_EXIT;
+    else if (strcmp(str, "char") == 0) *mode = CONSOLE_FLUSH_CHAR;
+    else return -1;
+    return 0;
+}
+
+static void capture_append(const char *data, size_t len) {
+    if (capture_len + len > capture_cap) {
+        size_t cap = capture_cap ? capture_cap : CONSOLE_BUF_SIZE;
+        while (cap < capture_len + len) cap *= 2;
+        char *grown = realloc(capture_buf, cap);
+        if (!grown) {
+            fprintf(stderr, "Out of memory while capturing console output\n");
+            exit(-1);
+        }
+        capture_buf = grown;
+        capture_cap = cap;
+    }
+    memcpy(capture_buf + capture_len, data, len);
+    capture_len += len;
+}
+
+void console_flush(void) {
+    if (out_len == 0) return;
+    if (capturing) {
+        capture_append(out_buf, out_len);
+    } else {
+        fwrite(out_buf, 1, out_len, stdout);
+        fflush(stdout);
+    }
+    out_len = 0;
+}
+
+void console_putchar(int c) {
+    out_buf[out_len++] = (char)c;
+    if (out_len == CONSOLE_BUF_SIZE
+        || flush_mode == CONSOLE_FLUSH_CHAR
+        || (flush_mode == CONSOLE_FLUSH_LINE && c == '\n')) {
+        console_flush();
+    }
+}
+
+int console_getchar(void) {
+    if (in_pos == in_len) {
+        if (in_eof) return -1;
+        // a program waiting for input should see its prompt first
+        console_flush();
+        ssize_t n;
+        do {
+            n = read(STDIN_FILENO, in_buf, sizeof(in_buf));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            in_eof = 1;
+            return -1;
+        }
+        in_pos = 0;
+        in_len = (size_t)n;
+    }
+    return in_buf[in_pos++];
+}
+
+void console_capture_begin(void) {
+    console_flush();
+    capturing = 1;
+    capture_buf = NULL;
+    capture_len = 0;
+    capture_cap = 0;
+}
+
+char *console_capture_end(size_t *len) {
+    console_flush();
+    capturing = 0;
+    char *result = capture_buf;
+    if (len) *len = capture_len;
+    capture_buf = NULL;
+    capture_len = 0;
+    capture_cap = 0;
+    return result;
+}
@@ -0,0 +1,28 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <stddef.h>
+
+// Buffered console used by the putchar/getchar system calls of the simulated program.
+
+typedef enum {
+    CONSOLE_FLUSH_LINE,     // write out on newline, full buffer and exit (default)
+    CONSOLE_FLUSH_EXIT,     // write out only on full buffer and exit
+    CONSOLE_FLUSH_CHAR      // write out every character (unbuffered)
+} console_flush_mode_t;
+
+void console_set_flush_mode(console_flush_mode_t mode);
+// returns 0 on success, -1 for an unknown mode name ("line", "exit" or "char")
+int console_parse_flush_mode(const char *str, console_flush_mode_t *mode);
+
+void console_putchar(int c);
+// next byte of input, or -1 at end of input
+int console_getchar(void);
+void console_flush(void);
+
+// While capturing, output is collected in memory instead of written to stdout.
+// console_capture_end() flushes and returns the captured bytes (caller frees, may be NULL).
+void console_capture_begin(void);
+char *console_capture_end(size_t *len);
+
+#endif
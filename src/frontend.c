@@ -0,0 +1,150 @@
+#include "frontend.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct btb_entry {
+    uint32_t pc;
+    uint32_t target;
+    uint64_t last_use;          // for LRU, 0 marks an empty way
+};
+
+struct frontend {
+    struct btb_entry *btb;
+    int sets;
+    int ways;
+    uint64_t clock;
+
+    uint32_t *ras;
+    int ras_depth;
+    int ras_top;                // next free slot, wraps around
+    int ras_count;
+    long call_depth;            // pushes minus pops, unbounded
+    long max_call_depth;
+
+    uint64_t btb_lookups;
+    uint64_t btb_hits;
+    uint64_t btb_target_mispredicts;
+    uint64_t ras_pushes;
+    uint64_t ras_pops;
+    uint64_t ras_overflows;
+    uint64_t ras_underflows;
+    uint64_t ras_mispredicts;
+};
+
+struct frontend *frontend_create(int btb_sets, int btb_ways, int ras_depth) {
+    if (btb_sets <= 0 || (btb_sets & (btb_sets - 1)) || btb_ways <= 0 || ras_depth <= 0) {
+        return NULL;
+    }
+    struct frontend *fe = calloc(1, sizeof(struct frontend));
+    if (!fe) return NULL;
+    fe->sets = btb_sets;
+    fe->ways = btb_ways;
+    fe->ras_depth = ras_depth;
+    fe->btb = calloc((size_t)btb_sets * btb_ways, sizeof(struct btb_entry));
+    fe->ras = calloc(ras_depth, sizeof(uint32_t));
+    if (!fe->btb || !fe->ras) {
+        frontend_delete(fe);
+        return NULL;
+    }
+    return fe;
+}
+
+void frontend_delete(struct frontend *fe) {
+    if (fe) {
+        free(fe->btb);
+        free(fe->ras);
+        free(fe);
+    }
+}
+
+// Looks up 'pc' and installs or refreshes its entry with 'target'. Returns 1 on
+// a hit, with the target that was predicted in '*predicted'.
+static int btb_access(struct frontend *fe, uint32_t pc, uint32_t target, uint32_t *predicted) {
+    struct btb_entry *set = &fe->btb[((pc >> 2) & (uint32_t)(fe->sets - 1)) * fe->ways];
+    struct btb_entry *victim = &set[0];
+    fe->clock++;
+    for (int w = 0; w < fe->ways; w++) {
+        if (set[w].last_use && set[w].pc == pc) {
+            *predicted = set[w].target;
+            set[w].target = target;
+            set[w].last_use = fe->clock;
+            return 1;
+        }
+        if (set[w].last_use < victim->last_use) victim = &set[w];
+    }
+    victim->pc = pc;
+    victim->target = target;
+    victim->last_use = fe->clock;
+    return 0;
+}
+
+static void ras_push(struct frontend *fe, uint32_t return_pc) {
+    fe->ras_pushes++;
+    if (++fe->call_depth > fe->max_call_depth) fe->max_call_depth = fe->call_depth;
+    if (fe->ras_count == fe->ras_depth) {
+        // the oldest return address is overwritten
+        fe->ras_overflows++;
+    } else {
+        fe->ras_count++;
+    }
+    fe->ras[fe->ras_top] = return_pc;
+    fe->ras_top = (fe->ras_top + 1) % fe->ras_depth;
+}
+
+// returns 0 if the stack was empty
+static int ras_pop(struct frontend *fe, uint32_t *return_pc) {
+    fe->ras_pops++;
+    if (fe->call_depth > 0) fe->call_depth--;
+    if (fe->ras_count == 0) {
+        fe->ras_underflows++;
+        return 0;
+    }
+    fe->ras_count--;
+    fe->ras_top = (fe->ras_top + fe->ras_depth - 1) % fe->ras_depth;
+    *return_pc = fe->ras[fe->ras_top];
+    return 1;
+}
+
+void frontend_direct(struct frontend *fe, uint32_t pc, uint32_t target, int push) {
+    uint32_t predicted;
+    fe->btb_lookups++;
+    if (btb_access(fe, pc, target, &predicted)) {
+        fe->btb_hits++;
+    }
+    if (push) ras_push(fe, pc + 4);
+}
+
+void frontend_indirect(struct frontend *fe, uint32_t pc, uint32_t target, int push, int pop) {
+    uint32_t predicted;
+    if (pop) {
+        if (!ras_pop(fe, &predicted) || predicted != target) {
+            fe->ras_mispredicts++;
+        }
+    } else {
+        fe->btb_lookups++;
+        if (btb_access(fe, pc, target, &predicted)) {
+            fe->btb_hits++;
+            if (predicted != target) fe->btb_target_mispredicts++;
+        }
+    }
+    if (push) ras_push(fe, pc + 4);
+}
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+void frontend_print_stats(const struct frontend *fe) {
+    printf("\n=== Front-end Statistics ===\n");
+    printf("BTB: %d sets x %d ways\n", fe->sets, fe->ways);
+    printf("BTB lookups: %lu\n", fe->btb_lookups);
+    printf("BTB hits: %lu (%.2f%%)\n", fe->btb_hits, percent(fe->btb_hits, fe->btb_lookups));
+    printf("BTB target mispredictions (jalr): %lu\n", fe->btb_target_mispredicts);
+    printf("RAS: %d entries\n", fe->ras_depth);
+    printf("RAS pushes: %lu, pops: %lu\n", fe->ras_pushes, fe->ras_pops);
+    printf("RAS overflows: %lu, underflows: %lu\n", fe->ras_overflows, fe->ras_underflows);
+    printf("Return target mispredictions: %lu (%.2f%%)\n", fe->ras_mispredicts,
+           percent(fe->ras_mispredicts, fe->ras_pops));
+    printf("Maximum call depth: %ld\n", fe->max_call_depth);
+    printf("============================\n\n");
+}
@@ -0,0 +1,26 @@
+#ifndef __FRONTEND_H__
+#define __FRONTEND_H__
+
+#include <stdint.h>
+
+// Front-end target prediction model: a set-associative branch target buffer
+// (LRU replacement, full tags) for taken branches and jumps, and a return
+// address stack. Only targets are modeled; directions are left to the branch
+// predictor.
+struct frontend;
+
+// 'btb_sets' must be a power of two
+struct frontend *frontend_create(int btb_sets, int btb_ways, int ras_depth);
+void frontend_delete(struct frontend *fe);
+
+// a taken conditional branch or a jal: the target is fixed, so only a BTB miss
+// can mispredict it. 'push' is set for calls.
+void frontend_direct(struct frontend *fe, uint32_t pc, uint32_t target, int push);
+
+// a jalr: returns ('pop') are predicted by the return address stack, other
+// jumps by the target last seen in the BTB. 'push' is set for calls.
+void frontend_indirect(struct frontend *fe, uint32_t pc, uint32_t target, int push, int pop);
+
+void frontend_print_stats(const struct frontend *fe);
+
+#endif
@@ -0,0 +1,213 @@
+#include "hle.h"
+#include "console.h"
+#include <stdlib.h>
+
+// Only state visible through the calling convention is reproduced: the return
+// value in a0 and the guest memory the routine touches. Caller-saved scratch
+// registers keep whatever value they had before the call.
+
+#define REG_A0 10
+#define REG_A1 11
+
+// lib.c allocator parameters (must match the guest build)
+#define SMALL_BLOCK_LIMIT 4096
+#define MIN_ALLOCATION 100
+#define BLOCK_SIZE_STEP 8
+#define NUM_SIZES (SMALL_BLOCK_LIMIT / BLOCK_SIZE_STEP)
+
+typedef enum {
+    HLE_PRINT_STRING,
+    HLE_UNS_TO_STR,
+    HLE_STR_TO_UNS,
+    HLE_ALLOCATE,
+    HLE_RELEASE,
+    HLE_NUM_ROUTINES
+} hle_routine_t;
+
+static const char *routine_names[HLE_NUM_ROUTINES] = {
+    "print_string", "uns_to_str", "str_to_uns", "allocate", "release"
+};
+
+struct hle {
+    uint32_t entry[HLE_NUM_ROUTINES];
+    hle_routine_t routine[HLE_NUM_ROUTINES];
+    int num_entries;
+    int credit_insns;
+    // allocator globals in guest memory
+    uint32_t initialized;
+    uint32_t small_block_headers;
+    uint32_t free_space;
+};
+
+struct hle *hle_create(struct symbols *symbols, int credit_insns) {
+    if (!symbols) return NULL;
+    struct hle *hle = calloc(1, sizeof(struct hle));
+    if (!hle) return NULL;
+    hle->credit_insns = credit_insns;
+
+    int have_heap = symbols_sym_to_value(symbols, "initialized", &hle->initialized) == 0
+        && symbols_sym_to_value(symbols, "small_block_headers", &hle->small_block_headers) == 0
+        && symbols_sym_to_value(symbols, "free_space", &hle->free_space) == 0;
+
+    for (int r = 0; r < HLE_NUM_ROUTINES; r++) {
+        unsigned int addr;
+        if ((r == HLE_ALLOCATE || r == HLE_RELEASE) && !have_heap) continue;
+        if (symbols_sym_to_value(symbols, routine_names[r], &addr) == 0) {
+            hle->entry[hle->num_entries] = addr;
+            hle->routine[hle->num_entries] = (hle_routine_t)r;
+            hle->num_entries++;
+        }
+    }
+    if (hle->num_entries == 0) {
+        free(hle);
+        return NULL;
+    }
+    return hle;
+}
+
+void hle_delete(struct hle *hle) {
+    free(hle);
+}
+
+// The instruction counts below follow the control flow of the lib.c build used
+// for the programs in predictor-benchmarks. Builds that reach free_space through
+// gp (radix.elf) execute one instruction less per chunk refill in allocate().
+
+static long print_string(struct memory *mem, int32_t *registers) {
+    uint32_t p = (uint32_t)registers[REG_A0];
+    long chars = 0;
+    int c;
+    while ((c = memory_rd_b(mem, (int)p++)) != 0) {
+        console_putchar(c);
+        chars++;
+    }
+    return 4 + 6 * chars;
+}
+
+static long uns_to_str(struct memory *mem, int32_t *registers) {
+    uint32_t buffer = (uint32_t)registers[REG_A0];
+    uint32_t val = (uint32_t)registers[REG_A1];
+    if (val == 0) {
+        memory_wr_b(mem, (int)buffer, '0');
+        memory_wr_b(mem, (int)(buffer + 1), 0);
+        registers[REG_A0] = 1;
+        return 10;
+    }
+    char digits[10];
+    int num_digits = 0;
+    while (val) {
+        digits[num_digits++] = (char)('0' + val % 10);
+        val /= 10;
+    }
+    for (int i = 0; i < num_digits; i++) {
+        memory_wr_b(mem, (int)(buffer + i), digits[num_digits - 1 - i]);
+    }
+    memory_wr_b(mem, (int)(buffer + num_digits), 0);
+    registers[REG_A0] = num_digits - 1;
+    return 9 + 8 * num_digits + 7 * (num_digits / 2);
+}
+
+static long str_to_uns(struct memory *mem, int32_t *registers) {
+    uint32_t p = (uint32_t)registers[REG_A0];
+    uint32_t val = (uint32_t)memory_rd_b(mem, (int)p++) - '0';
+    long extra_digits = 0;
+    int c;
+    while ((c = memory_rd_b(mem, (int)p++)) != 0) {
+        val = val * 10 + (uint32_t)c - '0';
+        extra_digits++;
+    }
+    registers[REG_A0] = (int32_t)val;
+    return 6 + 8 * extra_digits;
+}
+
+static long allocate(struct hle *hle, struct memory *mem, int32_t *registers) {
+    int32_t size = registers[REG_A0];
+    long insns = 3;
+    if (!memory_rd_w(mem, (int)hle->initialized)) {
+        memory_wr_w(mem, (int)hle->initialized, 1);
+        for (int j = 0; j < NUM_SIZES; j++) {
+            memory_wr_w(mem, (int)(hle->small_block_headers + 4 * j), 0);
+        }
+        insns += 7 + 3 * NUM_SIZES;
+    }
+    insns += 1;
+    if (size < 1) {
+        registers[REG_A0] = 0;
+        return insns + 2;
+    }
+    size += 4;
+    insns += 3;
+    int32_t offset = size & (BLOCK_SIZE_STEP - 1);
+    if (offset) {
+        size = (size & ~offset) + BLOCK_SIZE_STEP;
+        insns += 9;
+    } else {
+        insns += 6;
+    }
+    if (size >= SMALL_BLOCK_LIMIT) {
+        registers[REG_A0] = 0;
+        return insns + 2;
+    }
+    uint32_t header = hle->small_block_headers + 4 * (uint32_t)(size / BLOCK_SIZE_STEP);
+    insns += 6;
+    if (memory_rd_w(mem, (int)header) == 0) {
+        int32_t allocation = size * 10;
+        insns += 5;
+        if (allocation < MIN_ALLOCATION) {
+            allocation = (MIN_ALLOCATION / size) * size;
+            insns += 3;
+        }
+        uint32_t chunk = (uint32_t)memory_rd_w(mem, (int)hle->free_space);
+        memory_wr_w(mem, (int)hle->free_space, (int)(chunk + allocation));
+        insns += 7;
+        // split the chunk into blocks, linked from the lowest address upwards
+        uint32_t block = chunk + allocation - size;
+        uint32_t next = 0;
+        insns += 4;
+        while (1) {
+            memory_wr_w(mem, (int)block, (int)next);
+            next = block;
+            if (block - size < chunk) break;
+            block -= size;
+            insns += 5;
+        }
+        memory_wr_w(mem, (int)header, (int)next);
+        insns += 6;
+    } else {
+        insns += 5;
+    }
+    uint32_t block = (uint32_t)memory_rd_w(mem, (int)header);
+    memory_wr_w(mem, (int)header, memory_rd_w(mem, (int)block));
+    memory_wr_w(mem, (int)block, size);
+    registers[REG_A0] = (int32_t)(block + 4);
+    return insns;
+}
+
+static long release(struct hle *hle, struct memory *mem, int32_t *registers) {
+    uint32_t chunk = (uint32_t)registers[REG_A0] - 4;
+    int32_t size = memory_rd_w(mem, (int)chunk);
+    uint32_t header = hle->small_block_headers + 4 * (uint32_t)(size / BLOCK_SIZE_STEP);
+    memory_wr_w(mem, (int)chunk, memory_rd_w(mem, (int)header));
+    memory_wr_w(mem, (int)header, (int)chunk);
+    return 14;
+}
+
+int hle_call(struct hle *hle, struct memory *mem, int32_t *registers, uint32_t pc, long *insns) {
+    int i;
+    for (i = 0; i < hle->num_entries; i++) {
+        if (hle->entry[i] == pc) break;
+    }
+    if (i == hle->num_entries) return 0;
+
+    long cost = 0;
+    switch (hle->routine[i]) {
+        case HLE_PRINT_STRING: cost = print_string(mem, registers); break;
+        case HLE_UNS_TO_STR:   cost = uns_to_str(mem, registers); break;
+        case HLE_STR_TO_UNS:   cost = str_to_uns(mem, registers); break;
+        case HLE_ALLOCATE:     cost = allocate(hle, mem, registers); break;
+        case HLE_RELEASE:      cost = release(hle, mem, registers); break;
+        default: break;
+    }
+    *insns = hle->credit_insns ? cost : 0;
+    return 1;
+}
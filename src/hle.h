@@ -0,0 +1,24 @@
+#ifndef __HLE_H__
+#define __HLE_H__
+
+#include <stdint.h>
+#include "memory.h"
+#include "read_elf.h"
+
+// High-level emulation of the lib.c runtime routines (print_string, uns_to_str,
+// str_to_uns, allocate, release). Routines are located through the ELF symbol
+// table and executed natively instead of being interpreted.
+struct hle;
+
+// returns NULL if none of the routines are present in the symbol table.
+// With credit_insns set, each call is credited with the number of instructions
+// the shipped lib.c build would have executed.
+struct hle *hle_create(struct symbols *symbols, int credit_insns);
+void hle_delete(struct hle *hle);
+
+// If 'pc' is the entry of an emulated routine, run it against 'registers'/'mem'
+// and return 1; the caller then returns to the address in ra. '*insns' receives
+// the instruction count to credit (0 unless credit_insns was set).
+int hle_call(struct hle *hle, struct memory *mem, int32_t *registers, uint32_t pc, long *insns);
+
+#endif
@@ -0,0 +1,291 @@
+#include "loop_idiom.h"
+#include <stdlib.h>
+
+#define MAX_LOOP_LEN 16
+#define LOOP_CACHE_SIZE 256
+
+typedef enum {
+    LOOP_OP_STORE,
+    LOOP_OP_LOAD,
+    LOOP_OP_ADDI,
+    LOOP_OP_ADD
+} loop_op_kind_t;
+
+struct loop_op {
+    loop_op_kind_t kind;
+    uint32_t funct3;
+    uint32_t rd, rs1, rs2;
+    int32_t imm;
+};
+
+typedef enum {
+    LOOP_UNKNOWN,
+    LOOP_IDIOM,
+    LOOP_NOT_IDIOM
+} loop_state_t;
+
+struct loop_entry {
+    loop_state_t state;
+    uint32_t branch_pc;
+    uint32_t loop_start;
+    uint32_t words[MAX_LOOP_LEN];   // body including the branch, to catch modified code
+    int len;
+    struct loop_op ops[MAX_LOOP_LEN - 1];
+    int num_ops;
+    uint32_t branch_funct3;
+    uint32_t branch_rs1, branch_rs2;
+    int fill;                       // single store of an invariant value, no loads
+};
+
+struct loop_idioms {
+    struct loop_entry cache[LOOP_CACHE_SIZE];
+};
+
+struct loop_idioms *loop_idioms_create(void) {
+    return calloc(1, sizeof(struct loop_idioms));
+}
+
+void loop_idioms_delete(struct loop_idioms *li) {
+    free(li);
+}
+
+static uint32_t get_bits(uint32_t instr, int start, int end) {
+    return (instr >> start) & ((1 << (end - start + 1)) - 1);
+}
+static int32_t sign_extend(uint32_t value, int bits) {
+    if (value & (1 << (bits - 1))) {
+        return value | (~0U << bits);
+    }
+    return value;
+}
+
+// Decode one body instruction; returns 0 if it is outside the recognized subset.
+static int decode_op(uint32_t instr, struct loop_op *op) {
+    uint32_t opcode = get_bits(instr, 0, 6);
+    op->rd = get_bits(instr, 7, 11);
+    op->funct3 = get_bits(instr, 12, 14);
+    op->rs1 = get_bits(instr, 15, 19);
+    op->rs2 = get_bits(instr, 20, 24);
+    uint32_t funct7 = get_bits(instr, 25, 31);
+
+    switch (opcode) {
+        case 0x23:
+            if (op->funct3 > 0x2) return 0;
+            op->kind = LOOP_OP_STORE;
+            op->imm = sign_extend((get_bits(instr, 25, 31) << 5) | get_bits(instr, 7, 11), 12);
+            return 1;
+        case 0x03:
+            if (op->funct3 == 0x3 || op->funct3 > 0x5 || op->rd == 0) return 0;
+            op->kind = LOOP_OP_LOAD;
+            op->imm = sign_extend(get_bits(instr, 20, 31), 12);
+            return 1;
+        case 0x13:
+            if (op->funct3 != 0x0 || op->rd == 0 || op->rd != op->rs1) return 0;
+            op->kind = LOOP_OP_ADDI;
+            op->imm = sign_extend(get_bits(instr, 20, 31), 12);
+            return 1;
+        case 0x33:
+            if (op->funct3 != 0x0 || funct7 != 0x00 || op->rd == 0) return 0;
+            if (op->rd == op->rs2 && op->rd != op->rs1) {
+                op->rs2 = op->rs1;
+                op->rs1 = op->rd;
+            }
+            if (op->rd != op->rs1 || op->rs2 == op->rd) return 0;
+            op->kind = LOOP_OP_ADD;
+            op->imm = 0;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void analyze(struct loop_entry *e, struct memory *mem, uint32_t loop_start, uint32_t branch_pc) {
+    e->branch_pc = branch_pc;
+    e->loop_start = loop_start;
+    e->state = LOOP_NOT_IDIOM;
+    e->len = (int)((branch_pc - loop_start) / 4) + 1;
+    e->num_ops = 0;
+    if (branch_pc <= loop_start || e->len > MAX_LOOP_LEN) return;
+
+    uint32_t step_regs = 0, load_regs = 0;
+    int stores = 0;
+    for (int i = 0; i < e->len; i++) {
+        e->words[i] = (uint32_t)memory_rd_w(mem, (int)(loop_start + 4 * i));
+    }
+    for (int i = 0; i < e->len - 1; i++) {
+        struct loop_op *op = &e->ops[e->num_ops++];
+        if (!decode_op(e->words[i], op)) return;
+        if (op->kind == LOOP_OP_STORE) stores++;
+        else if (op->kind == LOOP_OP_LOAD) load_regs |= 1U << op->rd;
+        else step_regs |= 1U << op->rd;
+    }
+    // induction steps must be loop invariant and loaded values must not be stepped
+    if (step_regs & load_regs) return;
+    for (int i = 0; i < e->num_ops; i++) {
+        if (e->ops[i].kind == LOOP_OP_ADD && ((step_regs | load_regs) & (1U << e->ops[i].rs2))) return;
+    }
+
+    uint32_t branch = e->words[e->len - 1];
+    e->branch_funct3 = get_bits(branch, 12, 14);
+    e->branch_rs1 = get_bits(branch, 15, 19);
+    e->branch_rs2 = get_bits(branch, 20, 24);
+    if (get_bits(branch, 0, 6) != 0x63) return;
+    if (e->branch_funct3 != 0x1 && e->branch_funct3 < 0x4) return;
+    if (load_regs & ((1U << e->branch_rs1) | (1U << e->branch_rs2))) return;
+
+    e->fill = 0;
+    if (stores == 1 && load_regs == 0) {
+        for (int i = 0; i < e->num_ops; i++) {
+            if (e->ops[i].kind == LOOP_OP_STORE && !(step_regs & (1U << e->ops[i].rs2))) e->fill = 1;
+        }
+    }
+    e->state = LOOP_IDIOM;
+}
+
+// Number of iterations until the closing branch falls through, or 0 if that
+// cannot be determined without wrap-around.
+static int64_t trip_count(const struct loop_entry *e, const int32_t *registers, const int64_t *steps) {
+    uint32_t a = e->branch_rs1, b = e->branch_rs2;
+    int64_t delta = steps[a] - steps[b];
+    if (e->branch_funct3 == 0x1) {
+        // bne: first j > 0 with j * delta == b - a (mod 2^32)
+        int64_t diff = (int32_t)((uint32_t)registers[b] - (uint32_t)registers[a]);
+        if (delta == 0 || diff % delta != 0 || diff / delta <= 0) return 0;
+        return diff / delta;
+    }
+    int is_signed = e->branch_funct3 == 0x4 || e->branch_funct3 == 0x5;
+    int64_t a0 = is_signed ? (int64_t)registers[a] : (int64_t)(uint32_t)registers[a];
+    int64_t b0 = is_signed ? (int64_t)registers[b] : (int64_t)(uint32_t)registers[b];
+    int64_t d0 = a0 - b0;
+    int64_t j;
+    if (e->branch_funct3 == 0x4 || e->branch_funct3 == 0x6) {
+        // blt/bltu: taken while d0 + j * delta < 0
+        if (d0 + delta >= 0) j = 1;
+        else if (delta <= 0) return 0;
+        else j = (-d0 + delta - 1) / delta;
+    } else {
+        // bge/bgeu: taken while d0 + j * delta >= 0
+        if (d0 + delta < 0) j = 1;
+        else if (delta >= 0) return 0;
+        else j = d0 / -delta + 1;
+    }
+    int64_t lo = is_signed ? INT32_MIN : 0;
+    int64_t hi = is_signed ? INT32_MAX : UINT32_MAX;
+    int64_t a_end = a0 + j * steps[a], b_end = b0 + j * steps[b];
+    if (a_end < lo || a_end > hi || b_end < lo || b_end > hi) return 0;
+    return j;
+}
+
+static void store(struct memory *mem, loop_store_fn stored, uint32_t funct3, uint32_t addr, int32_t value) {
+    if (stored) stored(addr);
+    switch (funct3) {
+        case 0x0: memory_wr_b(mem, (int)addr, (int)(uint8_t)value); break;
+        case 0x1: memory_wr_h(mem, (int)addr, (int)(uint16_t)value); break;
+        case 0x2: memory_wr_w(mem, (int)addr, (int)(uint32_t)value); break;
+    }
+}
+
+static int32_t load(struct memory *mem, uint32_t funct3, uint32_t addr) {
+    switch (funct3) {
+        case 0x0: return (int8_t)memory_rd_b(mem, (int)addr);
+        case 0x1: return (int16_t)memory_rd_h(mem, (int)addr);
+        case 0x2: return memory_rd_w(mem, (int)addr);
+        case 0x4: return (uint8_t)memory_rd_b(mem, (int)addr);
+        case 0x5: return (uint16_t)memory_rd_h(mem, (int)addr);
+    }
+    return 0;
+}
+
+static void run_fill(const struct loop_entry *e, struct memory *mem, loop_store_fn stored, int32_t *registers,
+                     const int64_t *steps, int64_t trips) {
+    // all registers are induction variables or invariants: the store address
+    // is linear in the iteration number and the value is fixed
+    int64_t partial[32] = { 0 };
+    for (int i = 0; i < e->num_ops; i++) {
+        const struct loop_op *op = &e->ops[i];
+        if (op->kind == LOOP_OP_STORE) {
+            uint32_t addr = (uint32_t)registers[op->rs1] + (uint32_t)partial[op->rs1] + (uint32_t)op->imm;
+            uint32_t stride = (uint32_t)steps[op->rs1];
+            int32_t value = registers[op->rs2];
+            for (int64_t t = 0; t < trips; t++) {
+                store(mem, stored, op->funct3, addr, value);
+                addr += stride;
+            }
+        } else if (op->kind == LOOP_OP_ADDI) {
+            partial[op->rd] += op->imm;
+        } else {
+            partial[op->rd] += registers[op->rs2];
+        }
+    }
+    for (int r = 1; r < 32; r++) {
+        registers[r] = (int32_t)((uint32_t)registers[r] + (uint32_t)(steps[r] * trips));
+    }
+}
+
+static void run_body(const struct loop_entry *e, struct memory *mem, loop_store_fn stored, int32_t *registers,
+                     int64_t trips) {
+    for (int64_t t = 0; t < trips; t++) {
+        for (int i = 0; i < e->num_ops; i++) {
+            const struct loop_op *op = &e->ops[i];
+            switch (op->kind) {
+                case LOOP_OP_STORE:
+                    store(mem, stored, op->funct3, (uint32_t)registers[op->rs1] + (uint32_t)op->imm, registers[op->rs2]);
+                    break;
+                case LOOP_OP_LOAD:
+                    registers[op->rd] = load(mem, op->funct3, (uint32_t)registers[op->rs1] + (uint32_t)op->imm);
+                    break;
+                case LOOP_OP_ADDI:
+                    registers[op->rd] = (int32_t)((uint32_t)registers[op->rd] + (uint32_t)op->imm);
+                    break;
+                case LOOP_OP_ADD:
+                    registers[op->rd] = (int32_t)((uint32_t)registers[op->rd] + (uint32_t)registers[op->rs2]);
+                    break;
+            }
+        }
+    }
+}
+
+long loop_idioms_run(struct loop_idioms *li, struct memory *mem, int32_t *registers,
+                     uint32_t loop_start, uint32_t branch_pc, long max_insns,
+                     branch_predictor_t *predictor, loop_store_fn stored, struct loop_mix *mix) {
+    struct loop_entry *e = &li->cache[(branch_pc >> 2) % LOOP_CACHE_SIZE];
+    if (e->state == LOOP_UNKNOWN || e->branch_pc != branch_pc || e->loop_start != loop_start) {
+        analyze(e, mem, loop_start, branch_pc);
+    } else if (e->state == LOOP_IDIOM) {
+        for (int i = 0; i < e->len; i++) {
+            if ((uint32_t)memory_rd_w(mem, (int)(loop_start + 4 * i)) != e->words[i]) {
+                analyze(e, mem, loop_start, branch_pc);
+                break;
+            }
+        }
+    }
+    if (e->state != LOOP_IDIOM) return 0;
+
+    int64_t steps[32] = { 0 };
+    for (int i = 0; i < e->num_ops; i++) {
+        if (e->ops[i].kind == LOOP_OP_ADDI) steps[e->ops[i].rd] += e->ops[i].imm;
+        else if (e->ops[i].kind == LOOP_OP_ADD) steps[e->ops[i].rd] += registers[e->ops[i].rs2];
+    }
+    for (int r = 0; r < 32; r++) {
+        if (steps[r] < INT32_MIN || steps[r] > INT32_MAX) return 0;
+    }
+    int64_t trips = trip_count(e, registers, steps);
+    if (trips <= 0 || trips > max_insns / e->len) return 0;
+
+    if (e->fill) {
+        run_fill(e, mem, stored, registers, steps, trips);
+    } else {
+        run_body(e, mem, stored, registers, trips);
+    }
+    mix->branches += (long)trips;
+    for (int i = 0; i < e->num_ops; i++) {
+        if (e->ops[i].kind == LOOP_OP_LOAD) mix->loads += (long)trips;
+        else if (e->ops[i].kind == LOOP_OP_STORE) mix->stores += (long)trips;
+    }
+    if (predictor) {
+        for (int64_t t = 1; t <= trips; t++) {
+            predictor_update(predictor, branch_pc, loop_start, t < trips);
+        }
+    }
+    return (long)(trips * e->len);
+}
@@ -0,0 +1,41 @@
+#ifndef __LOOP_IDIOM_H__
+#define __LOOP_IDIOM_H__
+
+#include <stdint.h>
+#include "memory.h"
+#include "branch_predictor.h"
+
+// Recognition of simple counted store/copy loops, such as the initialization
+// and sieve loops in erat.c. A loop qualifies when its body is straight-line
+// code of loads, stores and self-increments (addi r,r,imm / add r,r,invariant)
+// closed by a backward conditional branch whose operands are induction
+// variables or loop invariants. The remaining iterations are then executed as
+// a host loop with the trip count computed up front.
+struct loop_idioms;
+
+// instruction mix of the iterations executed in bulk
+struct loop_mix {
+    long branches;
+    long loads;
+    long stores;
+};
+
+// called with the address of every store before it is made, e.g. to drop
+// predecoded instructions
+typedef void (*loop_store_fn)(uint32_t addr);
+
+struct loop_idioms *loop_idioms_create(void);
+void loop_idioms_delete(struct loop_idioms *li);
+
+// Called after the conditional branch at 'branch_pc' was taken back to
+// 'loop_start'. If the loop is a recognized idiom that will exit within
+// 'max_insns' instructions, all remaining iterations are executed: registers,
+// memory and predictor are updated exactly as interpretation would, and the
+// number of instructions executed is returned, with its mix added to '*mix'.
+// Every store is reported to 'stored' (may be NULL). Execution then continues
+// at branch_pc + 4. Returns 0 (and changes nothing) otherwise.
+long loop_idioms_run(struct loop_idioms *li, struct memory *mem, int32_t *registers,
+                     uint32_t loop_start, uint32_t branch_pc, long max_insns,
+                     branch_predictor_t *predictor, loop_store_fn stored, struct loop_mix *mix);
+
+#endif
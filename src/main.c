@@ -5,8 +5,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <time.h>
 #include "branch_predictor.h"
+#include "console.h"
+#include "outcome_profile.h"
+#include "aliasing.h"
+
+#define MAX_GUESTS 16
+#define DEFAULT_QUANTUM 100000
+#define MAX_RAS_DEPTH 65536
+#define MAX_BTB_SETS 65536
+#define MAX_BTB_WAYS 64
 
 void terminate(const char *error) {
   printf("%s\n", error);
@@ -17,9 +27,42 @@ void terminate(const char *error) {
   printf("      sim riscv-elf -l log     // simulate and log each instruction to file 'log'\n");
   printf("      sim riscv-elf -s log     // simulate and log only summary to file 'log'\n");
   printf("      sim riscv-elf -p TYPE    // enable branch predictor (see types below)\n");
+  printf("      sim riscv-elf -f MODE    // flush program output on 'line' (default), 'exit' or every 'char'\n");
+  printf("      sim riscv-elf -x         // run lib.c routines (print_string, allocate, ...) natively\n");
+  printf("      sim riscv-elf -xc        // as -x, but credit their instructions to the count\n");
+  printf("      sim riscv-elf -I         // interpret simple store/copy loops instead of running them in bulk\n");
+  printf("      sim riscv-elf -A         // report aliasing and utilization of predictor tables\n");
+  printf("      sim riscv-elf -H file    // as -A, and write per-entry utilization to 'file' (CSV)\n");
+  printf("      sim riscv-elf -D N       // model N branches in flight (bimodal and gshare predictors)\n");
+  printf("      sim riscv-elf -W H:file  // write an outcome profile with H bits of history to 'file'\n");
+  printf("      sim riscv-elf -L file    // start the predictor from the state saved in 'file'\n");
+  printf("      sim riscv-elf -S file    // save the predictor's state to 'file' at exit\n");
+  printf("      sim riscv-elf -P N       // report the N branches with the most mispredictions\n");
+  printf("      sim riscv-elf -C N       // classify branches by predictability, list the N most executed\n");
+  printf("      sim riscv-elf -T N file  // write interval metrics every N instructions to 'file'\n");
+  printf("                               // (CSV, or binary rows if 'file' ends in .bin)\n");
+  printf("      sim riscv-elf -G file[,args]  // time-slice another program (with comma separated\n");
+  printf("                               // arguments) on the same predictor; repeatable\n");
+  printf("      sim riscv-elf -Q N       // switch programs every N instructions (default %d)\n", DEFAULT_QUANTUM);
+  printf("      sim riscv-elf -B SxW     // model a BTB of S sets (a power of two) and W ways (default 512x4 with -R)\n");
+  printf("      sim riscv-elf -R N       // model a return address stack of N entries (default 16 with -B)\n");
   printf("    predictor types:\n");
   printf("      NT, BTFNT, bimodal-256, bimodal-1K, bimodal-4K, bimodal-16K,\n");
-  printf("      gshare-256, gshare-1K, gshare-4K, gshare-16K\n");
+  printf("      gshare-256, gshare-1K, gshare-4K, gshare-16K,\n");
+  printf("      tage-sc-l-8K, tage-sc-l-32K, tage-sc-l-64K   (storage budget in bytes; any\n");
+  printf("        budget from 2K to 1024K is accepted, e.g. tage-sc-l-16K)\n");
+  printf("      perceptron-256, perceptron-1K, perceptron-4K, perceptron-16K   (same storage as bimodal)\n");
+  printf("      bimodal:PARAMS, gshare:PARAMS   with PARAMS a comma separated list of\n");
+  printf("        entries=N (K/M suffixes), hist=BITS, ctr=BITS, index=pc|pc>>N, hash=xor|fold|pcfold|mult|gselect\n");
+  printf("        e.g. gshare:entries=64K,hist=20,ctr=3,hash=fold or bimodal:entries=1M,index=pc>>2\n");
+  printf("      bimode-N, agree-N, yags-N   for N = 256, 1K, 4K, 16K (same counters as gshare-N,\n");
+  printf("                                  plus N/4 bias bits for agree and the tags for yags)\n");
+  printf("      tournament-B-G   bimodal with B and gshare with G entries (e.g. tournament-1K-4K)\n");
+  printf("      pag-H-P, pap-H-P, sag-H-P   local history predictors with H histories\n");
+  printf("                                  and P counters per pattern table (e.g. pag-1K-1K)\n");
+  printf("      plugin:PATH.so[:ARGS]   predictor loaded from a shared object (see predictor_plugin.h)\n");
+  printf("      profile:FILE     majority direction of each branch in the outcome profile FILE (-W)\n");
+  printf("      oracle:FILE[:H]  majority direction of each branch and H bits of history in FILE\n");
   printf("    prog-args: arguments to the simulated program\n");
   printf("               these arguments are provided through argv. Puts '--' in argv[0]\n");
   printf("      sim riscv-elf -- gylletank   // run riscv-elf with 'gylletank' in argv[1]\n");
@@ -57,6 +100,30 @@ int pass_args_to_program(struct memory* mem, int argc, char* argv[]) {
   return seperator_position;
 }
 
+// Loads the program of a "-G file,arg,arg" option into 'g', with the arguments
+// passed as for the first program, and gives it lib.c emulation and bulk loops
+// of its own as enabled by 'shared'.
+static void load_guest(struct guest *g, char *spec, const struct sim_options *shared,
+                       int native_lib, int native_credit) {
+  char *args[34] = { "sim", "--" };
+  int count = 2;
+  g->name = strtok(spec, ",");
+  if (g->name == NULL) terminate("Missing program file for -G");
+  for (char *arg = strtok(NULL, ","); arg && count < 34; arg = strtok(NULL, ",")) {
+    args[count++] = arg;
+  }
+  g->mem = memory_create();
+  pass_args_to_program(g->mem, count, args);
+  struct program_info prog_info;
+  if (read_elf(g->mem, &prog_info, g->name, NULL)) exit(-1);
+  g->symbols = symbols_read_from_elf(g->name);
+  if (g->symbols == NULL) exit(-1);
+  g->start_addr = prog_info.start;
+  g->options = *shared;
+  g->options.loop_idioms = shared->loop_idioms ? loop_idioms_create() : NULL;
+  g->options.hle = native_lib ? hle_create(g->symbols, native_credit) : NULL;
+}
+
 // Helper function, prints disassembly
 void disassemble_to_stdout(struct memory* mem, struct program_info* prog_info, struct symbols* symbols) 
 {
@@ -69,18 +136,24 @@ void disassemble_to_stdout(struct memory* mem, struct program_info* prog_info, s
   }
 }
 
-predictor_type_t parse_predictor_type(const char *str) {
-    if (strcmp(str, "NT") == 0) return PRED_NT;
-    if (strcmp(str, "BTFNT") == 0) return PRED_BTFNT;
-    if (strcmp(str, "bimodal-256") == 0) return PRED_BIMODAL_256;
-    if (strcmp(str, "bimodal-1K") == 0) return PRED_BIMODAL_1K;
-    if (strcmp(str, "bimodal-4K") == 0) return PRED_BIMODAL_4K;
-    if (strcmp(str, "bimodal-16K") == 0) return PRED_BIMODAL_16K;
-    if (strcmp(str, "gshare-256") == 0) return PRED_GSHARE_256;
-    if (strcmp(str, "gshare-1K") == 0) return PRED_GSHARE_1K;
-    if (strcmp(str, "gshare-4K") == 0) return PRED_GSHARE_4K;
-    if (strcmp(str, "gshare-16K") == 0) return PRED_GSHARE_16K;
-    return PRED_NONE;
+// a decimal number in [min, max]; returns -1 for anything else
+static int parse_number(const char *str, long min, long max, int *value) {
+    char *end;
+    long n = strtol(str, &end, 10);
+    if (end == str || *end || n < min || n > max) return -1;
+    *value = (int)n;
+    return 0;
+}
+
+// "SETSxWAYS" with a power-of-two number of sets; returns -1 for anything else
+static int parse_btb_geometry(const char *str, int *sets, int *ways) {
+    char buf[32];
+    const char *x = strchr(str, 'x');
+    if (!x || (size_t)(x - str) >= sizeof(buf)) return -1;
+    memcpy(buf, str, x - str);
+    buf[x - str] = '\0';
+    if (parse_number(buf, 1, MAX_BTB_SETS, sets) || (*sets & (*sets - 1))) return -1;
+    return parse_number(x + 1, 1, MAX_BTB_WAYS, ways);
 }
 
 int main(int argc, char *argv[])
@@ -88,10 +161,28 @@ int main(int argc, char *argv[])
   struct memory *mem = memory_create();
   branch_predictor_t *predictor = NULL;
   argc = pass_args_to_program(mem, argc, argv);
-  if (argc == 2 || argc == 3 || argc == 4 || argc == 5)
+  if (argc >= 2)
   {
     FILE *log_file = NULL;
     FILE *prof_file = NULL;
+    int native_lib = 0;
+    int native_credit = 0;
+    int bulk_loops = 1;
+    int aliasing_report = 0;
+    const char *heatmap_file = NULL;
+    int branch_report = 0;
+    int analysis_report = 0;
+    int pipeline_depth = -1;
+    int recording_bits = -1;
+    const char *recording_file = NULL;
+    const char *load_file = NULL;
+    const char *save_file = NULL;
+    char *guest_specs[MAX_GUESTS];
+    int guest_count = 0;
+    long quantum = DEFAULT_QUANTUM;
+    struct timeline *timeline = NULL;
+    int btb_sets = 512, btb_ways = 4, ras_depth = 16;
+    int model_frontend = 0;
     int arg_idx = 2;
     while (arg_idx < argc && argv[arg_idx][0] == '-') {
         if (!strcmp(argv[arg_idx], "-l") && arg_idx + 1 < argc) {
@@ -109,17 +200,115 @@ int main(int argc, char *argv[])
             arg_idx += 2;
         }
         else if (!strcmp(argv[arg_idx], "-p") && arg_idx + 1 < argc) {
-            predictor_type_t type = parse_predictor_type(argv[arg_idx + 1]);
-            if (type == PRED_NONE) {
-                printf("Unknown predictor type: %s\n", argv[arg_idx + 1]);
-                terminate("Invalid predictor type");
-            }
-            predictor = predictor_create(type);
+            predictor = predictor_create_named(argv[arg_idx + 1]);
             if (!predictor) {
                 terminate("Could not create predictor");
             }
             arg_idx += 2;
         }
+        else if (!strcmp(argv[arg_idx], "-f") && arg_idx + 1 < argc) {
+            console_flush_mode_t mode;
+            if (console_parse_flush_mode(argv[arg_idx + 1], &mode)) {
+                printf("Unknown flush mode: %s\n", argv[arg_idx + 1]);
+                terminate("Invalid flush mode");
+            }
+            console_set_flush_mode(mode);
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-x") || !strcmp(argv[arg_idx], "-xc")) {
+            native_lib = 1;
+            native_credit = argv[arg_idx][2] == 'c';
+            arg_idx += 1;
+        }
+        else if (!strcmp(argv[arg_idx], "-I")) {
+            bulk_loops = 0;
+            arg_idx += 1;
+        }
+        else if (!strcmp(argv[arg_idx], "-A")) {
+            aliasing_report = 1;
+            arg_idx += 1;
+        }
+        else if (!strcmp(argv[arg_idx], "-H") && arg_idx + 1 < argc) {
+            aliasing_report = 1;
+            heatmap_file = argv[arg_idx + 1];
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-D") && arg_idx + 1 < argc) {
+            if (parse_number(argv[arg_idx + 1], 0, PREDICTOR_MAX_PIPELINE_DEPTH, &pipeline_depth)) {
+                terminate("Invalid number of branches in flight");
+            }
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-W") && arg_idx + 1 < argc) {
+            char *file_name;
+            recording_bits = (int)strtol(argv[arg_idx + 1], &file_name, 10);
+            if (*file_name != ':' || !file_name[1] || recording_bits < 0 || recording_bits > 64) {
+                terminate("Invalid outcome profile, expected HISTORY_BITS:FILE");
+            }
+            recording_file = file_name + 1;
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-L") && arg_idx + 1 < argc) {
+            load_file = argv[arg_idx + 1];
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-S") && arg_idx + 1 < argc) {
+            save_file = argv[arg_idx + 1];
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-P") && arg_idx + 1 < argc) {
+            branch_report = atoi(argv[arg_idx + 1]);
+            if (branch_report <= 0) {
+                terminate("Invalid number of branches to report");
+            }
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-C") && arg_idx + 1 < argc) {
+            analysis_report = atoi(argv[arg_idx + 1]);
+            if (analysis_report <= 0) {
+                terminate("Invalid number of branches to report");
+            }
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-T") && arg_idx + 2 < argc) {
+            int interval;
+            if (parse_number(argv[arg_idx + 1], 1, INT_MAX, &interval)) {
+                terminate("Invalid timeline interval");
+            }
+            timeline = timeline_create(argv[arg_idx + 2], interval);
+            if (timeline == NULL) {
+                terminate("Could not open timeline file, terminating.");
+            }
+            arg_idx += 3;
+        }
+        else if (!strcmp(argv[arg_idx], "-G") && arg_idx + 1 < argc) {
+            if (guest_count == MAX_GUESTS) {
+                terminate("Too many programs to time-slice");
+            }
+            guest_specs[guest_count++] = argv[arg_idx + 1];
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-Q") && arg_idx + 1 < argc) {
+            quantum = atol(argv[arg_idx + 1]);
+            if (quantum <= 0) {
+                terminate("Invalid quantum");
+            }
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-B") && arg_idx + 1 < argc) {
+            if (parse_btb_geometry(argv[arg_idx + 1], &btb_sets, &btb_ways)) {
+                terminate("Invalid BTB geometry, expected SETSxWAYS with a power-of-two number of sets");
+            }
+            model_frontend = 1;
+            arg_idx += 2;
+        }
+        else if (!strcmp(argv[arg_idx], "-R") && arg_idx + 1 < argc) {
+            if (parse_number(argv[arg_idx + 1], 1, MAX_RAS_DEPTH, &ras_depth)) {
+                terminate("Invalid return address stack depth");
+            }
+            model_frontend = 1;
+            arg_idx += 2;
+        }
         else {
             break;
         }
@@ -139,9 +328,76 @@ int main(int argc, char *argv[])
       disassemble_to_stdout(mem, &prog_info, symbols);
       exit(0);
     }
+    if (aliasing_report && (!predictor || predictor_enable_aliasing(predictor))) {
+      fprintf(stderr, "Aliasing report needs a bimodal, gshare, bimode, agree or yags predictor\n");
+    }
+    if (pipeline_depth >= 0 && (!predictor || predictor_enable_pipeline(predictor, pipeline_depth))) {
+      fprintf(stderr, "Pipeline depth needs a bimodal or gshare predictor and at most %d branches\n",
+              PREDICTOR_MAX_PIPELINE_DEPTH);
+    }
+    if (recording_file) {
+      // the profile does not depend on the predictor, so any will do
+      if (!predictor) {
+        predictor = predictor_create(PRED_NT);
+      }
+      if (!predictor || predictor_enable_recording(predictor, recording_bits)) {
+        terminate("Could not record outcome profile");
+      }
+    }
+    if (branch_report && (!predictor || predictor_enable_profile(predictor))) {
+      fprintf(stderr, "Per-branch report needs a predictor (-p)\n");
+    }
+    if (analysis_report) {
+      // like the outcome profile, the analysis does not depend on the predictor
+      if (!predictor) {
+        predictor = predictor_create(PRED_NT);
+      }
+      if (!predictor || predictor_enable_analysis(predictor)) {
+        terminate("Could not analyse branches");
+      }
+    }
+    if ((load_file || save_file) && !predictor) {
+      terminate("Saving or loading predictor state needs a predictor (-p)");
+    }
+    if (load_file && predictor_load(predictor, load_file)) {
+      terminate("Could not load predictor state (missing file, or saved by a different predictor)");
+    }
+    struct sim_options options = { NULL, NULL, NULL, branch_report, timeline, analysis_report };
+    if (model_frontend) {
+      options.frontend = frontend_create(btb_sets, btb_ways, ras_depth);
+      if (!options.frontend) {
+        terminate("Out of memory for the front-end model");
+      }
+    }
+    if (bulk_loops) {
+      options.loop_idioms = loop_idioms_create();
+    }
+    if (native_lib) {
+      options.hle = hle_create(symbols, native_credit);
+      if (options.hle == NULL) {
+        fprintf(stderr, "No lib.c routines found in symbol table, interpreting all code\n");
+      }
+    }
     int start_addr = prog_info.start;
+    struct guest guests[MAX_GUESTS + 1];
+    if (guest_count) {
+      if (log_file || prof_file || timeline || branch_report || analysis_report || recording_file) {
+        terminate("Logging, -T, -P, -C and -W cover a single program and cannot be used with -G");
+      }
+      memset(guests, 0, sizeof(guests));
+      guests[0].name = argv[1];
+      guests[0].mem = mem;
+      guests[0].symbols = symbols;
+      guests[0].start_addr = start_addr;
+      guests[0].options = options;
+      for (int i = 0; i < guest_count; i++) {
+        load_guest(&guests[i + 1], guest_specs[i], &options, native_lib, native_credit);
+      }
+    }
     clock_t before = clock();
-    struct Stat stats = simulate(mem, start_addr, log_file, symbols, predictor);
+    struct Stat stats = guest_count
+        ? simulate_shared(guests, guest_count + 1, quantum, predictor)
+        : simulate(mem, start_addr, log_file, symbols, predictor, &options);
     long int num_insns = stats.insns;
     clock_t after = clock();
     int ticks = after - before;
@@ -163,9 +419,37 @@ int main(int argc, char *argv[])
     {
       printf("\nSimulated %ld instructions in %d host ticks (%f MIPS)\n", num_insns, ticks, mips);
     }
+    if (recording_file && outcome_profile_write(predictor->recording, recording_file)) {
+        fprintf(stderr, "Could not write outcome profile %s\n", recording_file);
+    }
+    if (heatmap_file && predictor && predictor->aliasing
+        && aliasing_write(predictor->aliasing, heatmap_file)) {
+        fprintf(stderr, "Could not write table utilization to %s\n", heatmap_file);
+    }
+    if (save_file && predictor_save(predictor, save_file)) {
+        fprintf(stderr, "Could not save predictor state to %s\n", save_file);
+    }
     if (predictor) {
         predictor_destroy(predictor);
     }
+    if (options.hle) {
+        hle_delete(options.hle);
+    }
+    if (options.loop_idioms) {
+        loop_idioms_delete(options.loop_idioms);
+    }
+    if (options.frontend) {
+        frontend_delete(options.frontend);
+    }
+    if (options.timeline) {
+        timeline_delete(options.timeline);
+    }
+    for (int i = 1; i <= guest_count; i++) {
+        hle_delete(guests[i].options.hle);
+        loop_idioms_delete(guests[i].options.loop_idioms);
+        symbols_delete(guests[i].symbols);
+        memory_delete(guests[i].mem);
+    }
     memory_delete(mem);
   }
   else {
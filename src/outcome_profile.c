@@ -0,0 +1,182 @@
+#include "outcome_profile.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct context {
+    uint32_t pc;                // 0 marks an empty slot
+    uint64_t history;
+    uint64_t taken;
+    uint64_t not_taken;
+};
+
+// open-addressed hash table, kept at most half full
+struct outcome_profile {
+    int history_bits;
+    uint64_t history_mask;
+    struct context *slots;
+    uint32_t mask;
+    uint32_t count;
+    uint64_t history;           // for outcome_profile_record()
+};
+
+struct outcome_profile *outcome_profile_create(int history_bits) {
+    if (history_bits < 0 || history_bits > 64) return NULL;
+    struct outcome_profile *op = calloc(1, sizeof(struct outcome_profile));
+    if (!op) return NULL;
+    op->history_bits = history_bits;
+    op->history_mask = history_bits == 64 ? ~0ull : (1ull << history_bits) - 1;
+    op->mask = (1u << 10) - 1;
+    op->slots = calloc(op->mask + 1, sizeof(struct context));
+    if (!op->slots) {
+        free(op);
+        return NULL;
+    }
+    return op;
+}
+
+void outcome_profile_delete(struct outcome_profile *op) {
+    if (op) {
+        free(op->slots);
+        free(op);
+    }
+}
+
+int outcome_profile_history_bits(const struct outcome_profile *op) {
+    return op->history_bits;
+}
+
+static uint32_t hash_context(uint32_t pc, uint64_t history) {
+    uint64_t key = ((uint64_t)pc << 32) ^ history ^ (history >> 29);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+static struct context *find_slot(struct context *slots, uint32_t mask, uint32_t pc, uint64_t history) {
+    uint32_t slot = hash_context(pc, history) & mask;
+    while (slots[slot].pc != 0 && (slots[slot].pc != pc || slots[slot].history != history)) {
+        slot = (slot + 1) & mask;
+    }
+    return &slots[slot];
+}
+
+static void grow(struct outcome_profile *op) {
+    uint32_t mask = op->mask * 2 + 1;
+    struct context *slots = calloc((size_t)mask + 1, sizeof(struct context));
+    if (!slots) {
+        fprintf(stderr, "Out of memory for outcome profile\n");
+        exit(-1);
+    }
+    for (uint32_t i = 0; i <= op->mask; i++) {
+        if (op->slots[i].pc != 0) {
+            *find_slot(slots, mask, op->slots[i].pc, op->slots[i].history) = op->slots[i];
+        }
+    }
+    free(op->slots);
+    op->slots = slots;
+    op->mask = mask;
+}
+
+void outcome_profile_add(struct outcome_profile *op, uint32_t pc, uint64_t history,
+                         uint64_t taken, uint64_t not_taken) {
+    history &= op->history_mask;
+    struct context *c = find_slot(op->slots, op->mask, pc, history);
+    if (c->pc == 0) {
+        if (2 * (op->count + 1) > op->mask) {
+            grow(op);
+            c = find_slot(op->slots, op->mask, pc, history);
+        }
+        c->pc = pc;
+        c->history = history;
+        op->count++;
+    }
+    c->taken += taken;
+    c->not_taken += not_taken;
+}
+
+void outcome_profile_record(struct outcome_profile *op, uint32_t pc, int taken) {
+    outcome_profile_add(op, pc, op->history, taken != 0, taken == 0);
+    op->history = ((op->history << 1) | (taken != 0)) & op->history_mask;
+}
+
+int outcome_profile_majority(const struct outcome_profile *op, uint32_t pc, uint64_t history) {
+    const struct context *c = find_slot(op->slots, op->mask, pc, history & op->history_mask);
+    if (c->pc == 0) return -1;
+    return c->taken >= c->not_taken;
+}
+
+struct outcome_profile *outcome_profile_reduce(const struct outcome_profile *op, int history_bits) {
+    if (history_bits > op->history_bits) return NULL;
+    struct outcome_profile *reduced = outcome_profile_create(history_bits);
+    if (!reduced) return NULL;
+    for (uint32_t i = 0; i <= op->mask; i++) {
+        const struct context *c = &op->slots[i];
+        if (c->pc != 0) {
+            outcome_profile_add(reduced, c->pc, c->history, c->taken, c->not_taken);
+        }
+    }
+    return reduced;
+}
+
+void outcome_profile_foreach(const struct outcome_profile *op,
+                             void (*fn)(void *arg, uint32_t pc, uint64_t history,
+                                        uint64_t taken, uint64_t not_taken),
+                             void *arg) {
+    for (uint32_t i = 0; i <= op->mask; i++) {
+        const struct context *c = &op->slots[i];
+        if (c->pc != 0) {
+            fn(arg, c->pc, c->history, c->taken, c->not_taken);
+        }
+    }
+}
+
+uint32_t outcome_profile_contexts(const struct outcome_profile *op) {
+    return op->count;
+}
+
+uint32_t outcome_profile_branches(const struct outcome_profile *op) {
+    struct outcome_profile *per_branch = outcome_profile_reduce(op, 0);
+    if (!per_branch) return 0;
+    uint32_t branches = per_branch->count;
+    outcome_profile_delete(per_branch);
+    return branches;
+}
+
+int outcome_profile_write(const struct outcome_profile *op, const char *file_name) {
+    FILE *file = fopen(file_name, "w");
+    if (!file) return -1;
+    fprintf(file, "history_bits %d\n", op->history_bits);
+    for (uint32_t i = 0; i <= op->mask; i++) {
+        const struct context *c = &op->slots[i];
+        if (c->pc != 0) {
+            fprintf(file, "%08x %" PRIx64 " %" PRIu64 " %" PRIu64 "\n",
+                    c->pc, c->history, c->taken, c->not_taken);
+        }
+    }
+    return fclose(file) ? -1 : 0;
+}
+
+struct outcome_profile *outcome_profile_read(const char *file_name) {
+    FILE *file = fopen(file_name, "r");
+    if (!file) return NULL;
+    int history_bits;
+    struct outcome_profile *op = NULL;
+    if (fscanf(file, " history_bits %d", &history_bits) == 1) {
+        op = outcome_profile_create(history_bits);
+    }
+    uint32_t pc;
+    uint64_t history, taken, not_taken;
+    while (op && fscanf(file, "%" SCNx32 " %" SCNx64 " %" SCNu64 " %" SCNu64,
+                        &pc, &history, &taken, &not_taken) == 4) {
+        outcome_profile_add(op, pc, history, taken, not_taken);
+    }
+    if (op && !feof(file)) {
+        // trailing garbage
+        outcome_profile_delete(op);
+        op = NULL;
+    }
+    fclose(file);
+    return op;
+}
@@ -0,0 +1,48 @@
+#ifndef __OUTCOME_PROFILE_H__
+#define __OUTCOME_PROFILE_H__
+
+#include <stdint.h>
+
+// Taken/not-taken counts per branch and global history: the profile recorded by
+// one simulation and used by the profile-guided predictors in the next. The
+// history holds the outcomes of the last 'history_bits' conditional branches,
+// the most recent in bit 0.
+struct outcome_profile;
+
+// 'history_bits' may be 0..64
+struct outcome_profile *outcome_profile_create(int history_bits);
+void outcome_profile_delete(struct outcome_profile *op);
+int outcome_profile_history_bits(const struct outcome_profile *op);
+
+// counts an outcome in the context given by 'history' (masked to history_bits)
+void outcome_profile_add(struct outcome_profile *op, uint32_t pc, uint64_t history,
+                         uint64_t taken, uint64_t not_taken);
+
+// counts an outcome in the context of the profile's own history register, then
+// shifts the outcome into it (for recording a profile during a simulation)
+void outcome_profile_record(struct outcome_profile *op, uint32_t pc, int taken);
+
+// Returns the majority direction seen for the context (ties predict taken), or
+// -1 if the context never occurred.
+int outcome_profile_majority(const struct outcome_profile *op, uint32_t pc, uint64_t history);
+
+// The same outcomes with only the 'history_bits' most recent outcomes as
+// context; 'history_bits' must not exceed the profile's.
+struct outcome_profile *outcome_profile_reduce(const struct outcome_profile *op, int history_bits);
+
+// calls 'fn' for every context, in no particular order
+void outcome_profile_foreach(const struct outcome_profile *op,
+                             void (*fn)(void *arg, uint32_t pc, uint64_t history,
+                                        uint64_t taken, uint64_t not_taken),
+                             void *arg);
+
+// number of contexts and of distinct branches
+uint32_t outcome_profile_contexts(const struct outcome_profile *op);
+uint32_t outcome_profile_branches(const struct outcome_profile *op);
+
+// text format: a "history_bits N" line, then "pc history taken not_taken" per
+// context, in hex, hex, decimal and decimal
+int outcome_profile_write(const struct outcome_profile *op, const char *file_name);
+struct outcome_profile *outcome_profile_read(const char *file_name);
+
+#endif
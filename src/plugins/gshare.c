@@ -0,0 +1,70 @@
+// Example predictor plugin: gShare with a power-of-two number of 2-bit
+// counters given as the argument (default 4096), indexed like the built-in
+// gshare-N predictors so the two can be compared.
+//   make plugins && ./sim prog.elf -p plugin:plugins/gshare.so:4096
+#include "../predictor_plugin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct gshare {
+    uint8_t *counters;
+    uint32_t mask;
+    uint32_t history;
+};
+
+static void *gshare_create(const char *args) {
+    char *end = NULL;
+    long entries = *args ? strtol(args, &end, 10) : 4096;
+    if (end && (end == args || *end)) return NULL;
+    if (entries < 2 || (entries & (entries - 1))) return NULL;
+    struct gshare *g = calloc(1, sizeof(struct gshare));
+    if (!g) return NULL;
+    g->counters = malloc(entries);
+    if (!g->counters) {
+        free(g);
+        return NULL;
+    }
+    memset(g->counters, 2, entries);
+    g->mask = (uint32_t)entries - 1;
+    return g;
+}
+
+static int gshare_predict(void *state, uint32_t pc, uint32_t target) {
+    struct gshare *g = state;
+    (void)target;
+    return g->counters[((pc >> 2) ^ g->history) & g->mask] >= 2;
+}
+
+static uint64_t gshare_update(void *state, const predictor_plugin_branch_t *branches, uint32_t count) {
+    struct gshare *g = state;
+    uint64_t mispredictions = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t taken = branches[i].taken;
+        uint8_t *c = &g->counters[((branches[i].pc >> 2) ^ g->history) & g->mask];
+        mispredictions += (uint32_t)(*c >> 1) != taken;
+        if (taken) {
+            if (*c < 3) (*c)++;
+        } else if (*c > 0) {
+            (*c)--;
+        }
+        g->history = ((g->history << 1) | taken) & g->mask;
+    }
+    return mispredictions;
+}
+
+static void gshare_print_stats(void *state) {
+    struct gshare *g = state;
+    printf("Counters: %u\n", g->mask + 1);
+}
+
+static void gshare_destroy(void *state) {
+    struct gshare *g = state;
+    free(g->counters);
+    free(g);
+}
+
+const predictor_plugin_t predictor_plugin = {
+    PREDICTOR_PLUGIN_ABI_VERSION, "gshare", gshare_create, gshare_predict,
+    gshare_update, gshare_print_stats, gshare_destroy
+};
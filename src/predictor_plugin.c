@@ -0,0 +1,123 @@
+#include "branch_predictor.h"
+#include "predictor_plugin.h"
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct plugin {
+    void *handle;
+    const predictor_plugin_t *api;
+    void *state;
+    char *path;
+    uint32_t pending;
+    predictor_plugin_branch_t batch[PREDICTOR_PLUGIN_BATCH];
+};
+
+struct plugin_params {
+    const char *path;
+    const char *args;
+};
+
+static void plugin_flush(branch_predictor_t *pred) {
+    struct plugin *p = pred->state;
+    if (p->pending == 0) return;
+    pred->stats.mispredictions += p->api->update(p->state, p->batch, p->pending);
+    pred->stats.total_branches += p->pending;
+    p->pending = 0;
+}
+
+static int plugin_predict(branch_predictor_t *pred, uint32_t pc, uint32_t target) {
+    struct plugin *p = pred->state;
+    plugin_flush(pred);
+    return p->api->predict(p->state, pc, target) != 0;
+}
+
+static void plugin_update(branch_predictor_t *pred, uint32_t pc, uint32_t target, int taken) {
+    struct plugin *p = pred->state;
+    predictor_plugin_branch_t *b = &p->batch[p->pending];
+    b->pc = pc;
+    b->target = target;
+    b->taken = taken != 0;
+    if (++p->pending == PREDICTOR_PLUGIN_BATCH) {
+        plugin_flush(pred);
+    }
+}
+
+static void plugin_print_stats(branch_predictor_t *pred) {
+    struct plugin *p = pred->state;
+    printf("Plugin: %s (%s)\n", p->api->name, p->path);
+    if (p->api->print_stats) {
+        p->api->print_stats(p->state);
+    }
+}
+
+static void plugin_delete(struct plugin *p) {
+    if (p->state) p->api->destroy(p->state);
+    if (p->handle) dlclose(p->handle);
+    free(p->path);
+    free(p);
+}
+
+static void plugin_destroy(branch_predictor_t *pred) {
+    plugin_delete(pred->state);
+}
+
+// Loads the shared object and creates the plugin's state; prints the reason
+// and returns NULL on failure.
+static void *plugin_create(branch_predictor_t *pred, const void *params) {
+    const struct plugin_params *request = params;
+    const char *path = request->path;
+    const char *args = request->args ? request->args : "";
+    struct plugin *p = calloc(1, sizeof(struct plugin));
+    (void)pred;
+    if (!p) {
+        printf("Out of memory for predictor plugin %s\n", path);
+        return NULL;
+    }
+    p->path = strdup(path);
+    // a path without a slash would be searched for in the library path
+    char *local = malloc(strlen(path) + 3);
+    if (!p->path || !local) {
+        free(local);
+        printf("Out of memory for predictor plugin %s\n", path);
+        plugin_delete(p);
+        return NULL;
+    }
+    sprintf(local, "%s%s", strchr(path, '/') ? "" : "./", path);
+    p->handle = dlopen(local, RTLD_NOW | RTLD_LOCAL);
+    free(local);
+    if (!p->handle) {
+        printf("Could not load predictor plugin: %s\n", dlerror());
+        plugin_delete(p);
+        return NULL;
+    }
+    p->api = (const predictor_plugin_t *)dlsym(p->handle, PREDICTOR_PLUGIN_SYMBOL);
+    if (!p->api) {
+        printf("%s does not export '%s'\n", path, PREDICTOR_PLUGIN_SYMBOL);
+        plugin_delete(p);
+        return NULL;
+    }
+    if (p->api->abi_version != PREDICTOR_PLUGIN_ABI_VERSION) {
+        printf("%s has plugin ABI version %u, expected %d\n", path,
+               p->api->abi_version, PREDICTOR_PLUGIN_ABI_VERSION);
+        plugin_delete(p);
+        return NULL;
+    }
+    p->state = p->api->create(args);
+    if (!p->state) {
+        printf("Plugin %s rejected its arguments '%s'\n", p->api->name, args);
+        plugin_delete(p);
+        return NULL;
+    }
+    return p;
+}
+
+static const predictor_ops_t plugin_ops = {
+    plugin_create, plugin_predict, plugin_update, plugin_flush, plugin_print_stats, plugin_destroy,
+    NULL, NULL
+};
+
+branch_predictor_t* predictor_create_plugin(const char *path, const char *args) {
+    struct plugin_params params = { path, args };
+    return predictor_create_family(PRED_PLUGIN, &plugin_ops, &params);
+}
@@ -0,0 +1,40 @@
+#ifndef __PREDICTOR_PLUGIN_H__
+#define __PREDICTOR_PLUGIN_H__
+
+#include <stdint.h>
+
+// ABI for branch predictors loaded from shared objects with -p plugin:path.so:args.
+// A plugin exports one 'const predictor_plugin_t predictor_plugin' describing
+// itself. Build it with e.g. gcc -shared -fPIC -O2 my_predictor.c -o my_predictor.so
+// (see plugins/ for an example).
+//
+// Resolved branches reach the plugin in batches, in program order, to keep the
+// cost of the indirect call small. The plugin predicts each branch of a batch
+// before training on it, exactly as if it had seen them one at a time.
+#define PREDICTOR_PLUGIN_ABI_VERSION 1
+#define PREDICTOR_PLUGIN_SYMBOL "predictor_plugin"
+#define PREDICTOR_PLUGIN_BATCH 256
+
+typedef struct {
+    uint32_t pc;
+    uint32_t target;
+    uint32_t taken;
+} predictor_plugin_branch_t;
+
+typedef struct {
+    uint32_t abi_version;       // PREDICTOR_PLUGIN_ABI_VERSION
+    const char *name;
+    // 'args' is the text after the second ':' of the option, or "" if none.
+    // Returns the predictor state, or NULL if the arguments are rejected.
+    void *(*create)(const char *args);
+    // prediction for a branch that is not yet resolved; called only when no
+    // updates are pending
+    int (*predict)(void *state, uint32_t pc, uint32_t target);
+    // predicts and trains on 'count' branches, returns how many were mispredicted
+    uint64_t (*update)(void *state, const predictor_plugin_branch_t *branches, uint32_t count);
+    // prints the plugin's own statistics to stdout; may be NULL
+    void (*print_stats)(void *state);
+    void (*destroy)(void *state);
+} predictor_plugin_t;
+
+#endif
@@ -219,6 +219,38 @@ const char* symbols_value_to_sym(struct symbols* symbols, unsigned int value)
     return NULL;
 }
 
+int symbols_sym_to_value(struct symbols* symbols, const char* name, unsigned int* value)
+{
+    for (int i = 0; i < symbols->num_symbols; i++) {
+        if (ELF32_ST_BIND(symbols->symbols[i].st_info)
+            && strcmp(&symbols->strtab[symbols->symbols[i].st_name], name) == 0) {
+            *value = symbols->symbols[i].st_value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* symbols_containing_function(struct symbols* symbols, unsigned int value, unsigned int* offset)
+{
+    // a function whose extent covers 'value', else the closest one before it
+    const Elf32_Sym* best = NULL;
+    for (int i = 0; i < symbols->num_symbols; i++) {
+        const Elf32_Sym* sym = &symbols->symbols[i];
+        if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC || sym->st_value > value) continue;
+        if (value < sym->st_value + sym->st_size) {
+            best = sym;
+            break;
+        }
+        if (!best || sym->st_value > best->st_value) {
+            best = sym;
+        }
+    }
+    if (!best) return NULL;
+    *offset = value - best->st_value;
+    return &symbols->strtab[best->st_name];
+}
+
 void symbols_delete(struct symbols* symbols)
 {
     free(symbols->strtab);
@@ -27,5 +27,12 @@ void symbols_delete(struct symbols* symbols);
 // map a value to a symbol (return NULL if no matching symbol found)
 const char* symbols_value_to_sym(struct symbols* symbols, unsigned int value);
 
+// map an address to the function containing it and the offset into it
+// (return NULL if no function symbol lies at or below the address)
+const char* symbols_containing_function(struct symbols* symbols, unsigned int value, unsigned int* offset);
+
+// map a symbol to its value (return 0 if found, -1 if no symbol by that name exists)
+int symbols_sym_to_value(struct symbols* symbols, const char* name, unsigned int* value);
+
 
 #endif
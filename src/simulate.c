@@ -1,10 +1,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "simulate.h"
 #include "memory.h"
 #include "disassemble.h"
 #include "branch_predictor.h"
+#include "console.h"
+
+#define INSN_LIMIT 100000000
 
 static int32_t registers[32];
 static uint32_t pc;
@@ -220,14 +224,13 @@ static int handle_ecall(void) {
     
     switch (syscall_num) {
         case 1: {
-            int c = getchar();
+            int c = console_getchar();
             write_register(10, c);
             break;
         }
         case 2: {
             int c = read_register(10);
-            putchar(c);
-            fflush(stdout);
+            console_putchar(c);
             break;
         }
         case 3:
@@ -240,31 +243,383 @@ static int handle_ecall(void) {
     
     return 0;
 }
-struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file, 
-                     struct symbols* symbols, branch_predictor_t *predictor) {
-    struct Stat stats;
-    stats.insns = 0;
-    
-    init_register();
-    pc = (uint32_t)start_addr;
+// Predecoded instructions, kept per 64KB page of guest memory like the pages in memory.c.
+// Each entry holds the fields and immediate of one instruction; 'fused' marks the
+// first instruction of a pair that is executed as one superinstruction. An entry
+// decoded only as the second half of a pair is 'decoded' but not yet 'valid':
+// that happens once it has been checked as the start of a pair itself. On a
+// jalr, 'link' caches the entry of its last target (an inline cache checked against link_pc).
+typedef enum {
+    FUSED_NONE,
+    FUSED_LUI_ADDI,     // lui rd,hi ; addi rd2,rd,lo            (li)
+    FUSED_AUIPC_ADDI,   // auipc rd,hi ; addi rd2,rd,lo          (la)
+    FUSED_AUIPC_JALR,   // auipc rd,hi ; jalr rd2,lo(rd)         (call)
+    FUSED_SET_BRANCH    // slt[i][u] rd,.. ; beq/bne rd,zero,..  (compare and branch)
+} fused_t;
+
+typedef struct decoded {
+    uint32_t instr;
+    int32_t imm;
+    uint8_t valid, decoded;
+    uint8_t opcode, rd, rs1, rs2, funct3, funct7;
+    uint8_t fused;
+    uint32_t link_pc;
+    struct decoded *link;
+} decoded_t;
+
+#define DECODE_PAGE_ENTRIES 0x4000
+// never-valid entries past the end of a page, so return entries d[1]/d[2] can always be taken
+#define DECODE_PAGE_SENTINELS 2
+
+static decoded_t *decode_pages[0x10000];
+// numbers of the allocated pages, so a guest's pages can be switched out
+static uint16_t decode_page_list[0x10000];
+static unsigned decode_page_count;
+
+// Shadow of the guest's return addresses, pushed by calls (jal/jalr writing ra or t0)
+// and popped by returns (jalr x0 through ra or t0). A popped entry that matches the
+// actual return address lets the return continue without a lookup.
+#define RETURN_STACK_SIZE 256
+
+static struct {
+    uint32_t pc;
+    decoded_t *entry;
+} return_stack[RETURN_STACK_SIZE];
+static unsigned return_stack_top;
+
+static void decode_instruction(decoded_t *d, uint32_t instr) {
+    d->instr = instr;
+    d->opcode = get_bits(instr, 0, 6);
+    d->rd = get_bits(instr, 7, 11);
+    d->funct3 = get_bits(instr, 12, 14);
+    d->rs1 = get_bits(instr, 15, 19);
+    d->rs2 = get_bits(instr, 20, 24);
+    d->funct7 = get_bits(instr, 25, 31);
+    d->fused = FUSED_NONE;
+    d->link = NULL;
+    switch (d->opcode) {
+        case 0x13:
+            if (d->funct3 == 0x1 || d->funct3 == 0x5) {
+                d->imm = d->rs2;
+            } else {
+                d->imm = sign_extend(get_bits(instr, 20, 31), 12);
+            }
+            break;
+        case 0x03:
+        case 0x67:
+            d->imm = sign_extend(get_bits(instr, 20, 31), 12);
+            break;
+        case 0x23:
+            d->imm = sign_extend((get_bits(instr, 25, 31) << 5) | get_bits(instr, 7, 11), 12);
+            break;
+        case 0x63:
+            d->imm = sign_extend(
+                (get_bits(instr, 31, 31) << 12) |
+                (get_bits(instr, 7, 7) << 11) |
+                (get_bits(instr, 25, 30) << 5) |
+                (get_bits(instr, 8, 11) << 1),
+                13
+            );
+            break;
+        case 0x6F:
+            d->imm = sign_extend(
+                (get_bits(instr, 31, 31) << 20) |
+                (get_bits(instr, 12, 19) << 12) |
+                (get_bits(instr, 20, 20) << 11) |
+                (get_bits(instr, 21, 30) << 1),
+                21
+            );
+            break;
+        case 0x37:
+        case 0x17:
+            d->imm = (int32_t)(get_bits(instr, 12, 31) << 12);
+            break;
+        default:
+            d->imm = 0;
+            break;
+    }
+    d->decoded = 1;
+}
+
+static fused_t fusion_of(const decoded_t *first, const decoded_t *second) {
+    int addi = second->opcode == 0x13 && second->funct3 == 0x0 && second->rs1 == first->rd;
+    switch (first->opcode) {
+        case 0x37:
+            if (addi) return FUSED_LUI_ADDI;
+            break;
+        case 0x17:
+            if (addi) return FUSED_AUIPC_ADDI;
+            if (second->opcode == 0x67 && second->rs1 == first->rd) return FUSED_AUIPC_JALR;
+            break;
+        case 0x33:
+        case 0x13: {
+            int set_less = (first->funct3 == 0x2 || first->funct3 == 0x3)
+                && (first->opcode == 0x13 || first->funct7 == 0x00);
+            int test_rd = second->opcode == 0x63 && (second->funct3 == 0x0 || second->funct3 == 0x1)
+                && ((second->rs1 == first->rd && second->rs2 == 0)
+                    || (second->rs1 == 0 && second->rs2 == first->rd));
+            if (set_less && test_rd) return FUSED_SET_BRANCH;
+            break;
+        }
+    }
+    return FUSED_NONE;
+}
+
+static decoded_t *decode_miss(struct memory *mem, uint32_t addr);
+
+// The hit path is kept inline; it is on every instruction.
+static inline decoded_t *decode_lookup(struct memory *mem, uint32_t addr) {
+    decoded_t *page = decode_pages[addr >> 16];
+    if (page != NULL) {
+        decoded_t *d = &page[(addr >> 2) & (DECODE_PAGE_ENTRIES - 1)];
+        if (d->valid) return d;
+    }
+    return decode_miss(mem, addr);
+}
+
+static decoded_t *decode_miss(struct memory *mem, uint32_t addr) {
+    decoded_t *page = decode_pages[addr >> 16];
+    if (page == NULL) {
+        page = calloc(DECODE_PAGE_ENTRIES + DECODE_PAGE_SENTINELS, sizeof(decoded_t));
+        if (page == NULL) {
+            fprintf(stderr, "Out of memory for predecoded instructions\n");
+            exit(-1);
+        }
+        decode_pages[addr >> 16] = page;
+        decode_page_list[decode_page_count++] = (uint16_t)(addr >> 16);
+    }
+    uint32_t index = (addr >> 2) & (DECODE_PAGE_ENTRIES - 1);
+    decoded_t *d = &page[index];
+    if (!d->valid) {
+        if (!d->decoded) {
+            decode_instruction(d, (uint32_t)memory_rd_w(mem, (int)addr));
+        }
+        // pairs are only fused within a page so the second half is always d[1]
+        if (index + 1 < DECODE_PAGE_ENTRIES) {
+            if (!d[1].decoded) {
+                decode_instruction(&d[1], (uint32_t)memory_rd_w(mem, (int)(addr + 4)));
+            }
+            d->fused = fusion_of(d, &d[1]);
+        }
+        d->valid = 1;
+    }
+    return d;
+}
+
+// A store into a predecoded page drops the entry and any pair ending in it.
+static void decode_invalidate(uint32_t addr) {
+    decoded_t *page = decode_pages[addr >> 16];
+    if (page == NULL) return;
+    uint32_t index = (addr >> 2) & (DECODE_PAGE_ENTRIES - 1);
+    page[index].valid = page[index].decoded = 0;
+    if (index > 0) page[index - 1].valid = page[index - 1].decoded = 0;
+    if ((addr & 3) && index + 1 < DECODE_PAGE_ENTRIES) {
+        page[index + 1].valid = page[index + 1].decoded = 0;
+    }
+}
+
+static void decode_reset(void) {
+    for (unsigned i = 0; i < decode_page_count; i++) {
+        free(decode_pages[decode_page_list[i]]);
+        decode_pages[decode_page_list[i]] = NULL;
+    }
+    decode_page_count = 0;
+    return_stack_top = 0;
+}
+
+// Entry for the control transfer from 'd' to 'pc', through the entry's link.
+static decoded_t *follow_link(struct memory *mem, decoded_t *d) {
+    if (d->link && d->link_pc == pc && d->link->valid) {
+        return d->link;
+    }
+    d->link = decode_lookup(mem, pc);
+    d->link_pc = pc;
+    return d->link;
+}
+
+static int is_link_register(uint32_t reg) {
+    return reg == 1 || reg == 5;
+}
+
+// 'entry' is the (possibly not yet decoded) entry for return_pc
+static void push_return(uint32_t return_pc, decoded_t *entry) {
+    unsigned slot = return_stack_top++ % RETURN_STACK_SIZE;
+    return_stack[slot].pc = return_pc;
+    return_stack[slot].entry = entry;
+}
+
+// Entry for a return to 'pc', or NULL if the shadow stack predicted another address.
+static decoded_t *pop_return(void) {
+    if (return_stack_top == 0) return NULL;
+    unsigned slot = --return_stack_top % RETURN_STACK_SIZE;
+    if (return_stack[slot].pc != pc || !return_stack[slot].entry->valid) return NULL;
+    return return_stack[slot].entry;
+}
+
+// Entry after a jalr from 'd': returns use the shadow stack, calls push onto it,
+// and everything else (and mispredicted returns) goes through the inline cache.
+static decoded_t *indirect_jump(struct memory *mem, decoded_t *d, uint32_t rd, uint32_t rs1,
+                                uint32_t return_pc, decoded_t *return_entry) {
+    if (is_link_register(rd)) {
+        push_return(return_pc, return_entry);
+    } else if (rd == 0 && is_link_register(rs1)) {
+        decoded_t *entry = pop_return();
+        if (entry) return entry;
+    }
+    return follow_link(mem, d);
+}
+
+// Calls into routines handled by the hle module return straight to ra.
+static int call_native(struct hle *hle, struct memory *mem, struct Stat *stats) {
+    long credited;
+    if (!hle || !hle_call(hle, mem, registers, pc, &credited)) {
+        return 0;
+    }
+    stats->insns += credited;
+    pc = (uint32_t)read_register(1) & ~1U;
+    return 1;
+}
+
+// Front-end model for a jalr, following the RISC-V return address stack hints:
+// a link register in rd pushes, one in rs1 pops (unless it is the same register).
+// A call handled natively never returns through the stack, so it does not push;
+// pc is then already the return address, so the jump target is passed in.
+static void frontend_jalr(struct frontend *frontend, uint32_t jalr_pc, uint32_t target,
+                          uint32_t rd, uint32_t rs1, int native) {
+    int push = !native && is_link_register(rd);
+    int pop = is_link_register(rs1) && !(is_link_register(rd) && rd == rs1);
+    frontend_indirect(frontend, jalr_pc, target, push, pop);
+}
+
+static uint64_t mispredictions(branch_predictor_t *predictor) {
+    if (!predictor) return 0;
+    predictor_flush(predictor);
+    return predictor->stats.mispredictions;
+}
+
+static long sample_timeline(struct timeline *timeline, const struct Stat *stats,
+                            branch_predictor_t *predictor) {
+    return timeline_sample(timeline, stats->insns, stats->branches, mispredictions(predictor),
+                           stats->loads, stats->stores, stats->calls);
+}
+
+static void print_statistics(struct memory *mem, struct symbols *symbols, const struct Stat *stats,
+                             branch_predictor_t *predictor, const struct sim_options *options) {
+    if (options && options->timeline) {
+        sample_timeline(options->timeline, stats, predictor);
+    }
+    if (predictor) {
+        predictor_print_stats(predictor);
+        if (predictor->profile && options) {
+            branch_profile_print(predictor->profile, options->branch_report, mem, symbols);
+        }
+        if (predictor->analysis && options) {
+            branch_analysis_print(predictor->analysis, options->analysis_report, mem, symbols);
+        }
+    }
+    if (options && options->frontend) {
+        frontend_print_stats(options->frontend);
+    }
+}
+
+// Executes the superinstruction starting at 'd' (pc already points past the pair).
+// Returns the entry to continue with when it is known without a lookup, else NULL.
+static decoded_t *execute_fused(struct memory *mem, decoded_t *d, uint32_t current_pc,
+                                branch_predictor_t *predictor, struct frontend *frontend,
+                                struct hle *hle, struct Stat *stats) {
+    const decoded_t *second = &d[1];
+    switch (d->fused) {
+        case FUSED_LUI_ADDI:
+            write_register(d->rd, d->imm);
+            write_register(second->rd, read_register(d->rd) + second->imm);
+            break;
+        case FUSED_AUIPC_ADDI:
+            write_register(d->rd, (int32_t)(current_pc + d->imm));
+            write_register(second->rd, read_register(d->rd) + second->imm);
+            break;
+        case FUSED_AUIPC_JALR: {
+            write_register(d->rd, (int32_t)(current_pc + d->imm));
+            uint32_t target = (uint32_t)(read_register(d->rd) + second->imm) & ~1U;
+            write_register(second->rd, (int32_t)(current_pc + 8));
+            pc = target;
+            stats->calls += is_link_register(second->rd);
+            int native = call_native(hle, mem, stats);
+            if (frontend) {
+                frontend_jalr(frontend, current_pc + 4, target, second->rd, second->rs1, native);
+            }
+            if (native) break;
+            return indirect_jump(mem, d, second->rd, second->rs1, current_pc + 8, &d[2]);
+        }
+        case FUSED_SET_BRANCH: {
+            if (d->opcode == 0x33) {
+                execute_r_type(d->rd, d->rs1, d->rs2, d->funct3, d->funct7);
+            } else {
+                execute_i_type_alu(d->rd, d->rs1, d->funct3, d->imm, d->funct7);
+            }
+            uint32_t branch_pc = current_pc + 4;
+            uint32_t target_addr = (uint32_t)((int32_t)branch_pc + second->imm);
+            int branch_taken = execute_branch(second->rs1, second->rs2, second->funct3, second->imm, branch_pc);
+            stats->branches++;
+            if (predictor) {
+                predictor_update(predictor, branch_pc, target_addr, branch_taken);
+            }
+            if (frontend && branch_taken) {
+                frontend_direct(frontend, branch_pc, target_addr, 0);
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+// Runs from the current pc until the program ends (returns 1) or the instruction
+// count in 'io_stats' reaches 'stop' (returns 0, to be resumed at pc).
+static int run(struct memory *mem, FILE *log_file, struct symbols *symbols,
+               branch_predictor_t *predictor, const struct sim_options *options,
+               struct Stat *io_stats, long stop) {
+    struct Stat stats = *io_stats;
+    struct hle *hle = options ? options->hle : NULL;
+    struct frontend *frontend = options ? options->frontend : NULL;
+    // bulk loops skip the branches the front-end model has to see
+    struct loop_idioms *loop_idioms = (options && !log_file && !frontend) ? options->loop_idioms : NULL;
+    struct timeline *timeline = options ? options->timeline : NULL;
+    long next_sample = timeline ? timeline_sample(timeline, 0, 0, 0, 0, 0, 0) : INSN_LIMIT * 2L;
+    // the earlier of the next timeline sample and the end of the run
+    long next_check = next_sample < stop ? next_sample : stop;
 
     uint32_t jump_target = 0;
+    decoded_t *d = decode_lookup(mem, pc);
     
     while (1) {
-        uint32_t instr = (uint32_t)memory_rd_w(mem, (int)pc);
         uint32_t current_pc = pc;
+        if (stats.insns >= next_check) {
+            if (stats.insns >= stop) {
+                *io_stats = stats;
+                return 0;
+            }
+            next_sample = sample_timeline(timeline, &stats, predictor);
+            next_check = next_sample < stop ? next_sample : stop;
+        }
 
-        int is_jump_target = (current_pc == jump_target);
-        
-        char disassembly[256];
-        disassemble(current_pc, instr, disassembly, sizeof(disassembly), symbols);
-        
-        uint32_t opcode = get_bits(instr, 0, 6);
-        uint32_t rd = get_bits(instr, 7, 11);
-        uint32_t funct3 = get_bits(instr, 12, 14);
-        uint32_t rs1 = get_bits(instr, 15, 19);
-        uint32_t rs2 = get_bits(instr, 20, 24);
-        uint32_t funct7 = get_bits(instr, 25, 31);
+        // superinstructions are split again while logging, and where the pair would
+        // cross the instruction limit, a timeline sample or the end of a slice
+        if (d->fused && !log_file && stats.insns + 2 <= next_check && stats.insns + 2 <= INSN_LIMIT) {
+            pc = current_pc + 8;
+            stats.insns += 2;
+            decoded_t *next = execute_fused(mem, d, current_pc, predictor, frontend, hle, &stats);
+            d = next ? next : decode_lookup(mem, pc);
+            continue;
+        }
+        decoded_t *next = NULL;
+
+        uint32_t instr = d->instr;
+        uint32_t opcode = d->opcode;
+        uint32_t rd = d->rd;
+        uint32_t funct3 = d->funct3;
+        uint32_t rs1 = d->rs1;
+        uint32_t rs2 = d->rs2;
+        uint32_t funct7 = d->funct7;
+        int32_t imm = d->imm;
         
         pc = current_pc + 4;
 
@@ -278,6 +633,9 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
         stats.insns++;
 
         if (log_file) {
+            int is_jump_target = (current_pc == jump_target);
+            char disassembly[256];
+            disassemble(current_pc, instr, disassembly, sizeof(disassembly), symbols);
             if (is_jump_target) {
                 fprintf(log_file, "| %ld => | %08x : %08x | %-20s |", 
                         stats.insns, current_pc, instr, disassembly);
@@ -296,12 +654,6 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
             }
             
             case 0x13: {
-                int32_t imm;
-                if (funct3 == 0x1 || funct3 == 0x5) {
-                    imm = rs2;
-                } else {
-                    imm = sign_extend(get_bits(instr, 20, 31), 12);
-                }
                 execute_i_type_alu(rd, rs1, funct3, imm, funct7);
                 reg_written = rd;
                 reg_value = read_register(rd);
@@ -309,59 +661,73 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
             }
             
             case 0x03: {
-                int32_t imm = sign_extend(get_bits(instr, 20, 31), 12);
                 execute_load(mem, rd, rs1, funct3, imm);
+                stats.loads++;
                 reg_written = rd;
                 reg_value = read_register(rd);
                 break;
             }
             
             case 0x23: {
-                int32_t imm = sign_extend((get_bits(instr, 25, 31) << 5) | get_bits(instr, 7, 11), 12);
                 execute_store(mem, rs1, rs2, funct3, imm);
+                stats.stores++;
                 mem_written = 1;
                 mem_addr = (uint32_t)(read_register(rs1) + imm);
                 mem_value = read_register(rs2);
+                decode_invalidate(mem_addr);
                 break;
             }
             
             case 0x63: {
-                int32_t imm = sign_extend(
-                    (get_bits(instr, 31, 31) << 12) |
-                    (get_bits(instr, 7, 7) << 11) |
-                    (get_bits(instr, 25, 30) << 5) |
-                    (get_bits(instr, 8, 11) << 1),
-                    13
-                );  
                 uint32_t target_addr = (uint32_t)((int32_t)current_pc + imm);
                 branch_taken = execute_branch(rs1, rs2, funct3, imm, current_pc);
+                stats.branches++;
                 if (predictor) {
                     predictor_update(predictor, current_pc, target_addr, branch_taken);
                 }                
                 if (branch_taken) {
                     jump_target = pc;
+                    if (frontend) {
+                        frontend_direct(frontend, current_pc, target_addr, 0);
+                    }
+                    long bulk = 0;
+                    if (loop_idioms && imm < 0) {
+                        // a bulk run must not cross the end of a timeline interval or of the run
+                        long limit = (next_check < INSN_LIMIT ? next_check : INSN_LIMIT) - stats.insns;
+                        struct loop_mix mix = { 0, 0, 0 };
+                        bulk = loop_idioms_run(loop_idioms, mem, registers, pc, current_pc,
+                                               limit, predictor, decode_invalidate, &mix);
+                        stats.branches += mix.branches;
+                        stats.loads += mix.loads;
+                        stats.stores += mix.stores;
+                    }
+                    if (bulk) {
+                        stats.insns += bulk;
+                        pc = current_pc + 4;
+                    }
                 }
                 break;
             }
             
             case 0x6F: {
-                int32_t imm = sign_extend(
-                    (get_bits(instr, 31, 31) << 20) |
-                    (get_bits(instr, 12, 19) << 12) |
-                    (get_bits(instr, 20, 20) << 11) |
-                    (get_bits(instr, 21, 30) << 1),
-                    21
-                );
+                uint32_t target = (uint32_t)((int32_t)current_pc + imm);
                 write_register(rd, (int32_t)(current_pc + 4));
-                pc = (uint32_t)((int32_t)current_pc + imm);
+                pc = target;
                 reg_written = rd;
                 reg_value = read_register(rd);
+                stats.calls += is_link_register(rd);
+                int native = call_native(hle, mem, &stats);
+                if (!native && is_link_register(rd)) {
+                    push_return(current_pc + 4, &d[1]);
+                }
+                if (frontend) {
+                    frontend_direct(frontend, current_pc, target, !native && is_link_register(rd));
+                }
                 jump_target = pc;
                 break;
             }
             
             case 0x67: {
-                int32_t imm = sign_extend(get_bits(instr, 20, 31), 12);
                 int32_t base = read_register(rs1);
                 uint32_t target = (uint32_t)(base + imm);
                 target &= ~1U;
@@ -369,20 +735,26 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
                 pc = target;
                 reg_written = rd;
                 reg_value = read_register(rd);
+                stats.calls += is_link_register(rd);
+                int native = call_native(hle, mem, &stats);
+                if (frontend) {
+                    frontend_jalr(frontend, current_pc, target, rd, rs1, native);
+                }
+                if (!native) {
+                    next = indirect_jump(mem, d, rd, rs1, current_pc + 4, &d[1]);
+                }
                 jump_target = pc;
                 break;
             }
             
             case 0x37: {
-                uint32_t imm = get_bits(instr, 12, 31) << 12;
-                write_register(rd, (int32_t)imm);
+                write_register(rd, imm);
                 reg_written = rd;
                 reg_value = read_register(rd);
                 break;
             }
             
             case 0x17: {
-                uint32_t imm = get_bits(instr, 12, 31) << 12;
                 write_register(rd, (int32_t)(current_pc + imm));
                 reg_written = rd;
                 reg_value = read_register(rd);
@@ -395,23 +767,18 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
                         if (log_file) {
                             fprintf(log_file, "\n");
                         }
-                        
-                        if (predictor) {
-                            predictor_print_stats(predictor);
-                        }
-                        
-                        return stats;
+                        console_flush();
+                        *io_stats = stats;
+                        return 1;
                     }
                 }
                 break;
             }
             default:
+                console_flush();
                 fprintf(stderr, "Unknown instruction: 0x%08x at PC=0x%08x\n", instr, current_pc);
-                if (predictor) {
-                    predictor_print_stats(predictor);
-                }
-                
-                return stats;
+                *io_stats = stats;
+                return 1;
         }
         if (log_file) {
             if (reg_written >= 0) {
@@ -428,15 +795,192 @@ struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file,
             fprintf(log_file, "\n");
         }
         
-        if (stats.insns > 100000000) {
+        if (stats.insns > INSN_LIMIT) {
             fprintf(stderr, "Instruction limits reached\n");
             break;
         }
+        d = next ? next : decode_lookup(mem, pc);
     }
+    *io_stats = stats;
+    return 1;
+}
+
+struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file, 
+                     struct symbols* symbols, branch_predictor_t *predictor,
+                     const struct sim_options *options) {
+    struct Stat stats = { 0, 0, 0, 0, 0 };
+    init_register();
+    decode_reset();
+    pc = (uint32_t)start_addr;
+    run(mem, log_file, symbols, predictor, options, &stats, INSN_LIMIT * 2L);
+    console_flush();
+    print_statistics(mem, symbols, &stats, predictor, options);
   
+  decode_reset();
+  return stats;
+}
+
+// Interpreter state of a guest while another one runs. Its predecoded pages
+// stay allocated, so entries on its return stack remain valid.
+struct guest_context {
+    int32_t registers[32];
+    uint32_t pc;
+    unsigned page_count;
+    uint16_t page_list[0x10000];
+    decoded_t *pages[0x10000];      // by position in page_list
+    unsigned return_stack_top;
+    struct {
+        uint32_t pc;
+        decoded_t *entry;
+    } return_stack[RETURN_STACK_SIZE];
+    char *line;                     // console output after the last complete line
+    size_t line_len;
+};
+
+static void switch_out(struct guest_context *c) {
+    memcpy(c->registers, registers, sizeof(registers));
+    c->pc = pc;
+    c->page_count = decode_page_count;
+    for (unsigned i = 0; i < decode_page_count; i++) {
+        c->page_list[i] = decode_page_list[i];
+        c->pages[i] = decode_pages[decode_page_list[i]];
+        decode_pages[decode_page_list[i]] = NULL;
+    }
+    decode_page_count = 0;
+    c->return_stack_top = return_stack_top;
+    memcpy(c->return_stack, return_stack, sizeof(return_stack));
+}
+
+static void switch_in(const struct guest_context *c) {
+    memcpy(registers, c->registers, sizeof(registers));
+    pc = c->pc;
+    decode_page_count = c->page_count;
+    for (unsigned i = 0; i < c->page_count; i++) {
+        decode_page_list[i] = c->page_list[i];
+        decode_pages[c->page_list[i]] = c->pages[i];
+    }
+    return_stack_top = c->return_stack_top;
+    memcpy(return_stack, c->return_stack, sizeof(return_stack));
+}
+
+static double rate(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static const char *guest_basename(const struct guest *g) {
+    const char *base = strrchr(g->name, '/');
+    return base ? base + 1 : g->name;
+}
+
+// Writes the console output a guest captured during its slice, a line at a
+// time and tagged with its name; a partial line waits for the next slice, or
+// is ended with a newline once the guest has finished.
+static void guest_output(struct guest *g, char *data, size_t len, int finished) {
+    struct guest_context *c = g->context;
+    if (len > 0) {
+        char *grown = realloc(c->line, c->line_len + len);
+        if (!grown) {
+            fprintf(stderr, "Out of memory for guest output\n");
+            exit(-1);
+        }
+        memcpy(grown + c->line_len, data, len);
+        c->line = grown;
+        c->line_len += len;
+    }
+    free(data);
+    size_t start = 0;
+    for (size_t i = 0; i < c->line_len; i++) {
+        if (c->line[i] == '\n') {
+            printf("[%s] %.*s\n", guest_basename(g), (int)(i - start), c->line + start);
+            start = i + 1;
+        }
+    }
+    if (finished && start < c->line_len) {
+        printf("[%s] %.*s\n", guest_basename(g), (int)(c->line_len - start), c->line + start);
+        start = c->line_len;
+    }
+    if (start > 0) {
+        memmove(c->line, c->line + start, c->line_len - start);
+        c->line_len -= start;
+    }
+    fflush(stdout);
+}
+
+static void print_guests(const struct guest *guests, int count, long quantum, const struct Stat *total,
+                         const branch_predictor_t *predictor) {
+    printf("\n=== Time-sliced Programs (%d programs, quantum %ld instructions) ===\n", count, quantum);
+    printf("%-24s %12s %10s %10s %14s %7s\n", "program", "instructions", "slices", "branches",
+           "mispredictions", "rate");
+    for (int i = 0; i < count; i++) {
+        const struct guest *g = &guests[i];
+        printf("%-24s %12ld %10ld %10lu %14lu %6.2f%%\n", guest_basename(g), g->stats.insns, g->slices,
+               g->predicted, g->mispredictions, rate(g->mispredictions, g->predicted));
+    }
     if (predictor) {
-      predictor_print_stats(predictor);
+        printf("%-24s %12ld %10s %10lu %14lu %6.2f%%\n", "combined", total->insns, "",
+               predictor->stats.total_branches, predictor->stats.mispredictions,
+               rate(predictor->stats.mispredictions, predictor->stats.total_branches));
     }
-  
-  return stats;
-}
\ No newline at end of file
+    printf("=====================================================================\n");
+}
+
+struct Stat simulate_shared(struct guest *guests, int count, long quantum,
+                            branch_predictor_t *predictor) {
+    struct Stat total = { 0, 0, 0, 0, 0 };
+    for (int i = 0; i < count; i++) {
+        guests[i].context = calloc(1, sizeof(struct guest_context));
+        if (!guests[i].context) {
+            fprintf(stderr, "Out of memory for guest state\n");
+            exit(-1);
+        }
+        guests[i].context->pc = (uint32_t)guests[i].start_addr;
+    }
+    decode_reset();
+    int running = count;
+    while (running > 0) {
+        for (int i = 0; i < count; i++) {
+            struct guest *g = &guests[i];
+            if (g->finished) continue;
+            switch_in(g->context);
+            uint64_t predicted = predictor ? predictor->stats.total_branches : 0;
+            uint64_t mispredicted = predictor ? predictor->stats.mispredictions : 0;
+            console_capture_begin();
+            g->finished = run(g->mem, NULL, g->symbols, predictor, &g->options, &g->stats,
+                              g->stats.insns + quantum);
+            g->slices++;
+            if (predictor) {
+                predictor_flush(predictor);
+                g->predicted += predictor->stats.total_branches - predicted;
+                g->mispredictions += predictor->stats.mispredictions - mispredicted;
+            }
+            size_t output_len;
+            char *output = console_capture_end(&output_len);
+            guest_output(g, output, output_len, g->finished);
+            switch_out(g->context);
+            if (g->finished) {
+                running--;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        struct guest *g = &guests[i];
+        switch_in(g->context);
+        decode_reset();
+        free(g->context->line);
+        free(g->context);
+        g->context = NULL;
+        total.insns += g->stats.insns;
+        total.branches += g->stats.branches;
+        total.loads += g->stats.loads;
+        total.stores += g->stats.stores;
+        total.calls += g->stats.calls;
+    }
+    print_guests(guests, count, quantum, &total, predictor);
+    if (predictor) {
+        predictor_print_stats(predictor);
+    }
+    if (count > 0 && guests[0].options.frontend) {
+        frontend_print_stats(guests[0].options.frontend);
+    }
+    return total;
+}
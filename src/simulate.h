@@ -5,13 +5,64 @@
 #include "read_elf.h"
 #include <stdio.h>
 #include "branch_predictor.h"
+#include "hle.h"
+#include "loop_idiom.h"
+#include "frontend.h"
+#include "branch_profile.h"
+#include "branch_analysis.h"
+#include "timeline.h"
 
 // Simuler RISC-V program i givet lager og fra given start adresse
-struct Stat { long int insns; };
+struct Stat {
+    long int insns;
+    long int branches;  // conditional branches
+    long int loads;
+    long int stores;
+    long int calls;     // jal/jalr with a link register as destination
+};
+
+// Optional simulator features; a NULL options pointer or NULL member disables them.
+struct sim_options {
+    struct hle *hle;    // run lib.c routines natively instead of interpreting them
+    struct loop_idioms *loop_idioms;    // run simple store/copy loops in bulk (ignored while logging
+                                        // or modeling the front-end)
+    struct frontend *frontend;  // model BTB and return address stack for taken branches and jumps
+    int branch_report;  // number of branches in the per-branch report, if the predictor
+                        // has a profile (predictor_enable_profile())
+    struct timeline *timeline;  // interval metrics; bulk loops stop at interval ends
+    int analysis_report;    // number of branches in the predictability report, if the
+                            // predictor has an analysis (predictor_enable_analysis())
+};
 
 // NOTE: Use of symbols provide for nicer disassembly, but is not required for A4.
 // Feel free to remove this parameter or pass in a NULL pointer and ignore it.
 
 struct Stat simulate(struct memory *mem, int start_addr, FILE *log_file, 
-                     struct symbols* symbols, branch_predictor_t *predictor);
+                     struct symbols* symbols, branch_predictor_t *predictor,
+                     const struct sim_options *options);
+
+// One of several programs time-sliced on one simulated core (simulate_shared()).
+// Each has its own memory, registers, predecoded code and lib.c state; the
+// branch predictor and the front-end in 'options' are shared.
+struct guest {
+    const char *name;
+    struct memory *mem;
+    struct symbols *symbols;
+    int start_addr;
+    struct sim_options options;     // logging, timeline and reports are not supported
+    // results
+    struct Stat stats;
+    uint64_t predicted;             // branches seen by the shared predictor
+    uint64_t mispredictions;
+    long slices;
+    int finished;
+    struct guest_context *context;  // interpreter state while switched out
+};
+
+// Runs the guests round-robin, 'quantum' instructions at a time, until all of
+// them have ended, then prints the statistics per guest and of the predictor.
+// Console output is captured per guest and written a line at a time, each line
+// prefixed with the program's name. Returns the combined counts.
+struct Stat simulate_shared(struct guest *guests, int count, long quantum,
+                            branch_predictor_t *predictor);
 #endif
@@ -0,0 +1,564 @@
+#include "tage.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Sizes follow the structure of Seznec's TAGE-SC-L (CBP-2016), scaled down to
+// a storage budget (see size_config()).
+
+#define MAX_TABLES 12
+#define HIST_BUFFER 2048            // global history bits kept, power of two
+#define LOOP_ITER_BITS 14
+#define SC_TABLES 6                 // two bias tables and four global history tables
+#define SC_CTR_MAX 31
+#define SC_CTR_MIN -32
+#define USE_ALT_MAX 7
+#define USE_LOOP_MAX 63
+#define U_RESET_PERIOD (1 << 18)    // updates between halvings of the useful bits
+
+struct tage_config {
+    int budget_kb;                  // the sizes below fit in budget_kb * 8192 bits
+    int num_tables;
+    int log_bimodal;
+    int log_tagged;
+    int tag_min, tag_max;
+    int hist_min, hist_max;
+    int log_sc;
+    int log_loop;
+};
+
+// table counts, tag widths and history lengths by budget; the table sizes
+// are then chosen to fit (log sizes of 0 here)
+static const struct tage_config shapes[] = {
+    {  0,  7, 0, 0,  7, 10, 4,  300, 0, 5 },
+    { 16, 12, 0, 0,  8, 12, 4,  640, 0, 6 },
+    { 64, 12, 0, 0,  8, 13, 4, 1000, 0, 6 },
+};
+
+static const int sc_hist_len[SC_TABLES - 2] = { 6, 11, 18, 27 };
+
+// A folded (compressed) view of the last 'orig_len' history bits in 'comp_len' bits
+struct folded_history {
+    uint32_t comp;
+    int comp_len;
+    int orig_len;
+    int outpoint;
+};
+
+struct tagged_entry {
+    int8_t ctr;                     // 3-bit signed, taken when >= 0
+    uint8_t u;                      // 2-bit useful counter
+    uint16_t tag;
+};
+
+struct loop_entry {
+    uint16_t tag;
+    uint16_t past_iter;
+    uint16_t current_iter;
+    uint8_t confidence;
+    uint8_t age;
+    uint8_t dir;                    // direction of the loop body
+};
+
+// Everything computed for one prediction, reused by the update.
+struct lookup {
+    uint32_t index[MAX_TABLES];
+    uint16_t tag[MAX_TABLES];
+    uint32_t bimodal_index;
+    int provider, alt;              // table numbers, -1 for the bimodal table
+    int provider_pred, alt_pred;
+    int tage_pred;
+    int high_conf;
+    int weak_new;                   // provider entry looks newly allocated
+    int loop_index;
+    int loop_hit;
+    int loop_valid;
+    int loop_pred;
+    uint32_t sc_index[SC_TABLES];
+    int sc_sum;
+    int sc_pred;
+    int pred;
+};
+
+struct tage {
+    struct tage_config cfg;
+    int8_t *bimodal;                // 2-bit counters, 0..3
+    struct tagged_entry *tagged[MAX_TABLES];
+    int hist_len[MAX_TABLES];
+    int tag_bits[MAX_TABLES];
+    uint32_t path_mask[MAX_TABLES];
+    int path_rot[MAX_TABLES];
+    int pc_shift[MAX_TABLES];
+    struct folded_history index_fold[MAX_TABLES];
+    struct folded_history tag_fold[2][MAX_TABLES];
+
+    uint8_t ghist[HIST_BUFFER];
+    int ghist_ptr;
+    uint64_t recent_hist;           // newest bits of ghist, for the corrector
+    uint32_t path_hist;
+
+    int use_alt_on_na;
+    long updates;
+    uint32_t seed;
+
+    int8_t *sc[SC_TABLES];
+    int sc_threshold;
+    int sc_threshold_ctr;
+
+    struct loop_entry *loops;
+    int use_loop;
+
+    // how the final predictions were made
+    uint64_t provider_hits;
+    uint64_t sc_overrides, sc_override_correct;
+    uint64_t loop_overrides, loop_override_correct;
+};
+
+static int clamp(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static uint32_t next_random(struct tage *t) {
+    t->seed ^= t->seed << 13;
+    t->seed ^= t->seed >> 17;
+    t->seed ^= t->seed << 5;
+    return t->seed;
+}
+
+static void fold_init(struct folded_history *f, int orig_len, int comp_len) {
+    f->comp = 0;
+    f->orig_len = orig_len;
+    f->comp_len = comp_len;
+    f->outpoint = orig_len % comp_len;
+}
+
+static inline void fold_update(struct folded_history *f, const uint8_t *ghist, int ptr) {
+    f->comp = (f->comp << 1) | ghist[ptr & (HIST_BUFFER - 1)];
+    f->comp ^= (uint32_t)ghist[(ptr + f->orig_len) & (HIST_BUFFER - 1)] << f->outpoint;
+    f->comp ^= f->comp >> f->comp_len;
+    f->comp &= (1u << f->comp_len) - 1;
+}
+
+static int tag_bits(const struct tage_config *cfg, int i) {
+    int n = cfg->num_tables;
+    return cfg->tag_min + (cfg->tag_max - cfg->tag_min) * i / (n > 1 ? n - 1 : 1);
+}
+
+static long config_bits(const struct tage_config *cfg) {
+    long bits = 2L << cfg->log_bimodal;
+    for (int i = 0; i < cfg->num_tables; i++) {
+        bits += (long)(3 + 2 + tag_bits(cfg, i)) << cfg->log_tagged;
+    }
+    bits += (long)SC_TABLES * 6 << cfg->log_sc;
+    // tag, two iteration counts, confidence, age, direction
+    bits += (long)(16 + 2 * LOOP_ITER_BITS + 2 + 8 + 1) << cfg->log_loop;
+    bits += cfg->hist_max + 16;
+    return bits;
+}
+
+// The largest tagged tables that fit in the budget, with a bimodal table 8 (or
+// 4) times and SC tables half (or a quarter) their size; what is left then
+// grows the bimodal and SC tables. Returns -1 if the budget is too small.
+static int size_config(int budget_kb, struct tage_config *cfg) {
+    static const int ratios[][2] = { { 3, -1 }, { 2, -1 }, { 2, -2 } };
+    long budget = budget_kb * 8192L;
+    for (int i = 0; i < (int)(sizeof(shapes) / sizeof(shapes[0])); i++) {
+        if (shapes[i].budget_kb <= budget_kb) *cfg = shapes[i];
+    }
+    cfg->budget_kb = budget_kb;
+    // SC indices need at least 4 bits
+    for (cfg->log_tagged = 16; cfg->log_tagged >= 6; cfg->log_tagged--) {
+        for (int r = 0; r < (int)(sizeof(ratios) / sizeof(ratios[0])); r++) {
+            cfg->log_bimodal = cfg->log_tagged + ratios[r][0];
+            cfg->log_sc = cfg->log_tagged + ratios[r][1];
+            if (config_bits(cfg) <= budget) {
+                while (cfg->log_bimodal < 20) {
+                    cfg->log_bimodal++;
+                    if (config_bits(cfg) > budget) {
+                        cfg->log_bimodal--;
+                        break;
+                    }
+                }
+                while (cfg->log_sc < cfg->log_tagged) {
+                    cfg->log_sc++;
+                    if (config_bits(cfg) > budget) {
+                        cfg->log_sc--;
+                        break;
+                    }
+                }
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+struct tage *tage_create(int budget_kb) {
+    struct tage_config cfg;
+    if (budget_kb <= 0 || budget_kb > TAGE_MAX_BUDGET_KB || size_config(budget_kb, &cfg)) {
+        return NULL;
+    }
+    struct tage *t = calloc(1, sizeof(struct tage));
+    if (!t) return NULL;
+    t->cfg = cfg;
+    int n = t->cfg.num_tables;
+
+    t->bimodal = malloc(1u << t->cfg.log_bimodal);
+    int ok = t->bimodal != NULL;
+    for (int i = 0; i < n; i++) {
+        t->tagged[i] = calloc(1u << t->cfg.log_tagged, sizeof(struct tagged_entry));
+        ok = ok && t->tagged[i];
+    }
+    for (int i = 0; i < SC_TABLES; i++) {
+        t->sc[i] = calloc(1u << t->cfg.log_sc, 1);
+        ok = ok && t->sc[i];
+    }
+    t->loops = calloc(1u << t->cfg.log_loop, sizeof(struct loop_entry));
+    if (!ok || !t->loops) {
+        tage_delete(t);
+        return NULL;
+    }
+    for (int i = 0; i < (1 << t->cfg.log_bimodal); i++) {
+        t->bimodal[i] = 2;
+    }
+
+    // geometric series of history lengths from hist_min to hist_max: find the
+    // common ratio r with r^(n-1) = hist_max/hist_min by bisection (no libm)
+    double ratio = (double)t->cfg.hist_max / t->cfg.hist_min;
+    double lo = 1.0, hi = ratio;
+    for (int iter = 0; iter < 60; iter++) {
+        double r = (lo + hi) / 2, p = 1.0;
+        for (int k = 0; k < n - 1; k++) p *= r;
+        if (p < ratio) lo = r; else hi = r;
+    }
+    double len = t->cfg.hist_min;
+    for (int i = 0; i < n; i++) {
+        t->hist_len[i] = (int)(len + 0.5);
+        if (i > 0 && t->hist_len[i] <= t->hist_len[i - 1]) t->hist_len[i] = t->hist_len[i - 1] + 1;
+        len *= lo;
+    }
+    for (int i = 0; i < n; i++) {
+        t->tag_bits[i] = tag_bits(&t->cfg, i);
+        fold_init(&t->index_fold[i], t->hist_len[i], t->cfg.log_tagged);
+        fold_init(&t->tag_fold[0][i], t->hist_len[i], t->tag_bits[i]);
+        fold_init(&t->tag_fold[1][i], t->hist_len[i], t->tag_bits[i] - 1);
+        int path_len = t->hist_len[i] < 16 ? t->hist_len[i] : 16;
+        t->path_mask[i] = (1u << path_len) - 1;
+        // rotate the path bits differently per table to decorrelate the tables
+        t->path_rot[i] = i % t->cfg.log_tagged;
+        t->pc_shift[i] = t->cfg.log_tagged - i % 4;
+    }
+    t->sc_threshold = 35;
+    t->seed = 0x2545f491;
+    return t;
+}
+
+void tage_delete(struct tage *t) {
+    if (!t) return;
+    free(t->bimodal);
+    for (int i = 0; i < MAX_TABLES; i++) {
+        free(t->tagged[i]);
+    }
+    for (int i = 0; i < SC_TABLES; i++) {
+        free(t->sc[i]);
+    }
+    free(t->loops);
+    free(t);
+}
+
+static uint32_t tagged_index(const struct tage *t, int i, uint32_t pcs) {
+    int log = t->cfg.log_tagged;
+    uint32_t path = t->path_hist & t->path_mask[i];
+    int rot = t->path_rot[i];
+    path = ((path << rot) | (path >> (16 - rot))) & 0xffff;
+    uint32_t index = pcs ^ (pcs >> t->pc_shift[i]) ^ t->index_fold[i].comp ^ path ^ (path >> log);
+    return index & ((1u << log) - 1);
+}
+
+static uint16_t tagged_tag(const struct tage *t, int i, uint32_t pcs) {
+    uint32_t tag = pcs ^ t->tag_fold[0][i].comp ^ (t->tag_fold[1][i].comp << 1);
+    return (uint16_t)(tag & ((1u << t->tag_bits[i]) - 1));
+}
+
+static uint32_t sc_index(const struct tage *t, int i, uint32_t pcs, const struct lookup *l) {
+    uint32_t mask = (1u << t->cfg.log_sc) - 1;
+    if (i == 0) {
+        return ((pcs << 1) | (uint32_t)l->tage_pred) & mask;
+    }
+    if (i == 1) {
+        return ((pcs << 2) ^ (pcs >> t->cfg.log_sc) ^ ((uint32_t)l->high_conf << 1) ^ (uint32_t)l->tage_pred) & mask;
+    }
+    int len = sc_hist_len[i - 2];
+    uint64_t h = t->recent_hist & ((1ull << len) - 1);
+    uint32_t folded = (uint32_t)(h ^ (h >> t->cfg.log_sc) ^ (h >> (2 * t->cfg.log_sc)));
+    return (pcs ^ (pcs >> (t->cfg.log_sc - i)) ^ folded) & mask;
+}
+
+static void compute(struct tage *t, uint32_t pc, struct lookup *l) {
+    uint32_t pcs = pc >> 2;
+    int n = t->cfg.num_tables;
+
+    // TAGE: longest matching history provides, the next longest is the alternate
+    l->bimodal_index = pcs & ((1u << t->cfg.log_bimodal) - 1);
+    l->provider = l->alt = -1;
+    for (int i = n - 1; i >= 0; i--) {
+        l->index[i] = tagged_index(t, i, pcs);
+        l->tag[i] = tagged_tag(t, i, pcs);
+        if (t->tagged[i][l->index[i]].tag == l->tag[i]) {
+            if (l->provider < 0) l->provider = i;
+            else if (l->alt < 0) l->alt = i;
+        }
+    }
+    int bimodal_pred = t->bimodal[l->bimodal_index] >= 2;
+    l->alt_pred = l->alt >= 0 ? t->tagged[l->alt][l->index[l->alt]].ctr >= 0 : bimodal_pred;
+    if (l->provider >= 0) {
+        const struct tagged_entry *e = &t->tagged[l->provider][l->index[l->provider]];
+        l->provider_pred = e->ctr >= 0;
+        l->weak_new = (e->ctr == 0 || e->ctr == -1) && e->u == 0;
+        l->high_conf = e->ctr == 3 || e->ctr == -4;
+        l->tage_pred = (l->weak_new && t->use_alt_on_na >= 0) ? l->alt_pred : l->provider_pred;
+    } else {
+        l->provider_pred = bimodal_pred;
+        l->weak_new = 0;
+        l->high_conf = t->bimodal[l->bimodal_index] == 0 || t->bimodal[l->bimodal_index] == 3;
+        l->tage_pred = bimodal_pred;
+    }
+
+    // SC: sum of centered counters, overrides TAGE when confidently disagreeing
+    l->sc_sum = 0;
+    for (int i = 0; i < SC_TABLES; i++) {
+        l->sc_index[i] = sc_index(t, i, pcs, l);
+        l->sc_sum += 2 * t->sc[i][l->sc_index[i]] + 1;
+    }
+    l->sc_pred = l->sc_sum >= 0;
+    l->pred = l->tage_pred;
+    if (l->sc_pred != l->tage_pred && abs(l->sc_sum) >= t->sc_threshold) {
+        l->pred = l->sc_pred;
+    }
+
+    // L: a loop with a confident trip count overrides both
+    l->loop_index = (int)(pcs & ((1u << t->cfg.log_loop) - 1));
+    const struct loop_entry *le = &t->loops[l->loop_index];
+    uint16_t loop_tag = (uint16_t)((pcs >> t->cfg.log_loop) & 0xffff);
+    l->loop_hit = le->age > 0 && le->tag == loop_tag;
+    l->loop_valid = l->loop_hit && le->confidence == 3;
+    l->loop_pred = (le->current_iter + 1 == le->past_iter) ? !le->dir : le->dir;
+    if (l->loop_valid && t->use_loop >= 0) {
+        l->pred = l->loop_pred;
+    }
+}
+
+int tage_predict(struct tage *t, uint32_t pc) {
+    struct lookup l;
+    compute(t, pc, &l);
+    return l.pred;
+}
+
+static void ctr_update(int8_t *ctr, int taken, int lo, int hi) {
+    if (taken) {
+        if (*ctr < hi) (*ctr)++;
+    } else {
+        if (*ctr > lo) (*ctr)--;
+    }
+}
+
+static void loop_update(struct tage *t, uint32_t pc, int taken, const struct lookup *l) {
+    struct loop_entry *le = &t->loops[l->loop_index];
+    if (l->loop_hit) {
+        if (l->loop_valid) {
+            if (taken != l->loop_pred) {
+                // the trip count changed: free the entry
+                le->age = 0;
+                le->confidence = 0;
+                le->past_iter = 0;
+                le->current_iter = 0;
+                return;
+            }
+            if (l->loop_pred != l->tage_pred && le->age < 255) le->age++;
+        }
+        le->current_iter = (le->current_iter + 1) & ((1u << LOOP_ITER_BITS) - 1);
+        if (le->past_iter != 0 && le->current_iter > le->past_iter) {
+            le->confidence = 0;
+            le->past_iter = 0;
+        }
+        if (taken != le->dir) {
+            // loop exit
+            if (le->current_iter == le->past_iter) {
+                if (le->confidence < 3) le->confidence++;
+                // very short loops are better left to TAGE
+                if (le->past_iter < 3) le->age = 0;
+            } else if (le->past_iter == 0) {
+                le->past_iter = le->current_iter;
+            } else {
+                le->age = 0;
+            }
+            le->current_iter = 0;
+        }
+    } else if (taken != l->tage_pred && (next_random(t) & 3) == 0) {
+        if (le->age > 0) {
+            le->age--;
+        } else {
+            le->tag = (uint16_t)(((pc >> 2) >> t->cfg.log_loop) & 0xffff);
+            le->past_iter = 0;
+            le->current_iter = 0;
+            le->confidence = 0;
+            le->age = 7;
+            le->dir = !taken;
+        }
+    }
+}
+
+static void tage_train(struct tage *t, int taken, const struct lookup *l) {
+    int n = t->cfg.num_tables;
+
+    if (l->provider >= 0 && l->weak_new && l->provider_pred != l->alt_pred) {
+        t->use_alt_on_na = clamp(t->use_alt_on_na + (l->alt_pred == taken ? 1 : -1),
+                                 -USE_ALT_MAX - 1, USE_ALT_MAX);
+    }
+
+    // allocate entries with longer histories on a misprediction
+    if (l->tage_pred != taken && l->provider < n - 1) {
+        int start = l->provider + 1;
+        if (start < n - 1 && (next_random(t) & 1)) start++;
+        int allocated = 0;
+        for (int i = start; i < n && allocated < 2; i++) {
+            struct tagged_entry *e = &t->tagged[i][l->index[i]];
+            if (e->u == 0) {
+                e->tag = l->tag[i];
+                e->ctr = taken ? 0 : -1;
+                allocated++;
+                i++;        // spread allocations over non-adjacent tables
+            }
+        }
+        if (!allocated) {
+            for (int i = start; i < n; i++) {
+                struct tagged_entry *e = &t->tagged[i][l->index[i]];
+                if (e->u > 0) e->u--;
+            }
+        }
+    }
+
+    if (l->provider >= 0) {
+        struct tagged_entry *e = &t->tagged[l->provider][l->index[l->provider]];
+        // a provider that is not yet useful shares the training with the alternate
+        if (e->u == 0) {
+            if (l->alt >= 0) {
+                ctr_update(&t->tagged[l->alt][l->index[l->alt]].ctr, taken, -4, 3);
+            } else {
+                ctr_update(&t->bimodal[l->bimodal_index], taken, 0, 3);
+            }
+        }
+        ctr_update(&e->ctr, taken, -4, 3);
+        if (l->provider_pred != l->alt_pred) {
+            if (l->provider_pred == taken) {
+                if (e->u < 3) e->u++;
+            } else if (e->u > 0) {
+                e->u--;
+            }
+        }
+    } else {
+        ctr_update(&t->bimodal[l->bimodal_index], taken, 0, 3);
+    }
+
+    // graceful aging of the useful bits
+    if (++t->updates % U_RESET_PERIOD == 0) {
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < (1 << t->cfg.log_tagged); k++) {
+                t->tagged[i][k].u >>= 1;
+            }
+        }
+    }
+}
+
+static void sc_train(struct tage *t, int taken, const struct lookup *l) {
+    if (l->sc_pred != l->tage_pred) {
+        if (l->sc_pred != taken) {
+            if (++t->sc_threshold_ctr > 31) {
+                t->sc_threshold++;
+                t->sc_threshold_ctr = 0;
+            }
+        } else if (abs(l->sc_sum) < t->sc_threshold) {
+            if (--t->sc_threshold_ctr < -32) {
+                if (t->sc_threshold > 1) t->sc_threshold--;
+                t->sc_threshold_ctr = 0;
+            }
+        }
+    }
+    if (l->sc_pred != taken || abs(l->sc_sum) < t->sc_threshold) {
+        for (int i = 0; i < SC_TABLES; i++) {
+            ctr_update(&t->sc[i][l->sc_index[i]], taken, SC_CTR_MIN, SC_CTR_MAX);
+        }
+    }
+}
+
+static void history_update(struct tage *t, uint32_t pc, int taken) {
+    t->ghist_ptr = (t->ghist_ptr - 1) & (HIST_BUFFER - 1);
+    t->ghist[t->ghist_ptr] = (uint8_t)(taken ? 1 : 0);
+    t->recent_hist = (t->recent_hist << 1) | (taken ? 1 : 0);
+    t->path_hist = ((t->path_hist << 1) ^ ((pc >> 2) & 1)) & 0xffff;
+    for (int i = 0; i < t->cfg.num_tables; i++) {
+        fold_update(&t->index_fold[i], t->ghist, t->ghist_ptr);
+        fold_update(&t->tag_fold[0][i], t->ghist, t->ghist_ptr);
+        fold_update(&t->tag_fold[1][i], t->ghist, t->ghist_ptr);
+    }
+}
+
+int tage_update(struct tage *t, uint32_t pc, int taken) {
+    struct lookup l;
+    compute(t, pc, &l);
+
+    if (l.provider >= 0) t->provider_hits++;
+    if (l.loop_valid && t->use_loop >= 0 && l.loop_pred != l.tage_pred) {
+        t->loop_overrides++;
+        if (l.loop_pred == taken) t->loop_override_correct++;
+    } else if (l.pred != l.tage_pred) {
+        t->sc_overrides++;
+        if (l.pred == taken) t->sc_override_correct++;
+    }
+
+    if (l.loop_valid && l.loop_pred != l.tage_pred) {
+        t->use_loop = clamp(t->use_loop + (l.loop_pred == taken ? 1 : -1),
+                            -USE_LOOP_MAX - 1, USE_LOOP_MAX);
+    }
+    loop_update(t, pc, taken, &l);
+    sc_train(t, taken, &l);
+    tage_train(t, taken, &l);
+    history_update(t, pc, taken);
+    return l.pred;
+}
+
+long tage_storage_bits(const struct tage *t) {
+    return config_bits(&t->cfg);
+}
+
+void tage_state(struct tage *t, void (*visit)(void *arg, void *data, size_t bytes, int shape), void *arg) {
+    visit(arg, &t->cfg, sizeof(t->cfg), 1);
+    visit(arg, t->bimodal, (size_t)1 << t->cfg.log_bimodal, 0);
+    for (int i = 0; i < t->cfg.num_tables; i++) {
+        visit(arg, t->tagged[i], ((size_t)1 << t->cfg.log_tagged) * sizeof(struct tagged_entry), 0);
+    }
+    for (int i = 0; i < SC_TABLES; i++) {
+        visit(arg, t->sc[i], (size_t)1 << t->cfg.log_sc, 0);
+    }
+    visit(arg, t->loops, ((size_t)1 << t->cfg.log_loop) * sizeof(struct loop_entry), 0);
+    visit(arg, t->ghist, sizeof(t->ghist), 0);
+    visit(arg, &t->ghist_ptr, sizeof(t->ghist_ptr), 0);
+    visit(arg, t->index_fold, sizeof(t->index_fold), 0);
+    visit(arg, t->tag_fold, sizeof(t->tag_fold), 0);
+    visit(arg, &t->recent_hist, sizeof(t->recent_hist), 0);
+    visit(arg, &t->path_hist, sizeof(t->path_hist), 0);
+    visit(arg, &t->use_alt_on_na, sizeof(t->use_alt_on_na), 0);
+    visit(arg, &t->updates, sizeof(t->updates), 0);
+    visit(arg, &t->seed, sizeof(t->seed), 0);
+    visit(arg, &t->sc_threshold, sizeof(t->sc_threshold), 0);
+    visit(arg, &t->sc_threshold_ctr, sizeof(t->sc_threshold_ctr), 0);
+    visit(arg, &t->use_loop, sizeof(t->use_loop), 0);
+}
+
+void tage_print_stats(const struct tage *t) {
+    long bits = tage_storage_bits(t);
+    printf("Storage: %ld bits (%.1f KB of a %d KB budget), %d tagged tables, history %d..%d\n",
+           bits, bits / 8192.0, t->cfg.budget_kb, t->cfg.num_tables, t->hist_len[0], t->hist_len[t->cfg.num_tables - 1]);
+    printf("Tagged provider hits: %lu\n", t->provider_hits);
+    printf("SC overrides: %lu (%lu correct)\n", t->sc_overrides, t->sc_override_correct);
+    printf("Loop overrides: %lu (%lu correct)\n", t->loop_overrides, t->loop_override_correct);
+}
@@ -0,0 +1,35 @@
+#ifndef __TAGE_H__
+#define __TAGE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// TAGE-SC-L: a bimodal base predictor and a set of tagged tables indexed with
+// geometrically increasing global history lengths (TAGE), a statistical
+// corrector that can revert TAGE predictions with a poor track record (SC) and
+// a loop predictor for branches with a constant trip count (L).
+struct tage;
+
+// Sizes the tables to fit 'budget_kb' KB of predictor state: 7 tagged tables
+// below 16 KB, 12 from there on, with longer histories from 64 KB. Returns
+// NULL for budgets outside 2..TAGE_MAX_BUDGET_KB.
+#define TAGE_MAX_BUDGET_KB 1024
+struct tage *tage_create(int budget_kb);
+void tage_delete(struct tage *t);
+
+// prediction for the conditional branch at 'pc', without changing any state
+int tage_predict(struct tage *t, uint32_t pc);
+
+// predicts, trains all components with the outcome and returns the prediction
+int tage_update(struct tage *t, uint32_t pc, int taken);
+
+// storage actually used by the configuration, in bits
+long tage_storage_bits(const struct tage *t);
+
+void tage_print_stats(const struct tage *t);
+
+// Passes each block of the predictor's state to 'visit' (see predictor_state_fn
+// in branch_predictor.h), the configuration first as a shape block.
+void tage_state(struct tage *t, void (*visit)(void *arg, void *data, size_t bytes, int shape), void *arg);
+
+#endif
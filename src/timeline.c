@@ -0,0 +1,71 @@
+#include "timeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct timeline {
+    FILE *file;
+    int binary;
+    long interval;
+    long next;
+    uint64_t last[TIMELINE_COLUMNS];    // cumulative counts at the last row
+    uint64_t current[TIMELINE_COLUMNS];
+};
+
+struct timeline *timeline_create(const char *file_name, long interval) {
+    if (interval <= 0) return NULL;
+    struct timeline *tl = calloc(1, sizeof(struct timeline));
+    if (!tl) return NULL;
+    size_t length = strlen(file_name);
+    tl->binary = length > 4 && !strcmp(file_name + length - 4, ".bin");
+    tl->file = fopen(file_name, tl->binary ? "wb" : "w");
+    if (!tl->file) {
+        free(tl);
+        return NULL;
+    }
+    tl->interval = interval;
+    tl->next = interval;
+    if (!tl->binary) {
+        fprintf(tl->file, "end_insn,insns,branches,mispredictions,loads,stores,calls\n");
+    }
+    return tl;
+}
+
+static void write_row(struct timeline *tl) {
+    uint64_t row[TIMELINE_COLUMNS];
+    row[0] = tl->current[0];
+    for (int i = 1; i < TIMELINE_COLUMNS; i++) {
+        row[i] = tl->current[i] - tl->last[i];
+    }
+    if (tl->binary) {
+        fwrite(row, sizeof(uint64_t), TIMELINE_COLUMNS, tl->file);
+    } else {
+        fprintf(tl->file, "%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                row[0], row[1], row[2], row[3], row[4], row[5], row[6]);
+    }
+    memcpy(tl->last, tl->current, sizeof(tl->last));
+}
+
+long timeline_sample(struct timeline *tl, long insns, long branches, uint64_t mispredictions,
+                     long loads, long stores, long calls) {
+    uint64_t current[TIMELINE_COLUMNS] = {
+        (uint64_t)insns, (uint64_t)insns, (uint64_t)branches, mispredictions,
+        (uint64_t)loads, (uint64_t)stores, (uint64_t)calls
+    };
+    memcpy(tl->current, current, sizeof(current));
+    if (insns >= tl->next) {
+        write_row(tl);
+        // a long bulk step may have covered several intervals
+        tl->next = (insns / tl->interval + 1) * tl->interval;
+    }
+    return tl->next;
+}
+
+void timeline_delete(struct timeline *tl) {
+    if (!tl) return;
+    if (tl->current[0] > tl->last[0]) {
+        write_row(tl);
+    }
+    fclose(tl->file);
+    free(tl);
+}
@@ -0,0 +1,25 @@
+#ifndef __TIMELINE_H__
+#define __TIMELINE_H__
+
+#include <stdint.h>
+
+// Interval metrics for plotting program phases: every 'interval' instructions a
+// row with the instructions, conditional branches, mispredictions, loads,
+// stores and calls of the interval is written. Files ending in ".bin" get
+// binary rows of TIMELINE_COLUMNS uint64_t in host byte order; anything else
+// gets CSV with a header line. The first column is the cumulative instruction
+// count at the end of the interval.
+#define TIMELINE_COLUMNS 7
+
+struct timeline;
+
+struct timeline *timeline_create(const char *file_name, long interval);
+// writes the last, partial interval and closes the file
+void timeline_delete(struct timeline *tl);
+
+// Cumulative counts so far; writes a row if an interval has ended. Returns the
+// instruction count at which the next call is due.
+long timeline_sample(struct timeline *tl, long insns, long branches, uint64_t mispredictions,
+                     long loads, long stores, long calls);
+
+#endif